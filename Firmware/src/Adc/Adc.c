@@ -9,7 +9,8 @@
 
 #include "Adc.h"
 #include "definitions.h"
-#include "Fifo.h"
+#include "Events/Events.h"
+#include "FifoRecord.h"
 #include "Timer/Timer.h"
 
 //------------------------------------------------------------------------------
@@ -42,7 +43,7 @@ typedef struct {
 } Accumulator;
 
 /**
- * @brief FIFO packet.
+ * @brief FIFO packet. Packets are written and read in place.
  */
 typedef struct {
     uint64_t timestamp;
@@ -54,13 +55,14 @@ typedef struct {
     uint32_t ch6;
     uint32_t ch7;
     uint32_t ch8;
-} __attribute__((__packed__)) FifoPacket;
+} FifoPacket;
 
 //------------------------------------------------------------------------------
 // Variables
 
-static uint8_t fifoData[100 * sizeof (FifoPacket)];
-static Fifo fifo = {.data = fifoData, .dataSize = sizeof (fifoData)};
+static FifoPacket fifoPackets[128];
+static FifoStatistics fifoStatistics;
+static FifoRecord fifo = FIFO_RECORD_WITH_STATISTICS(fifoPackets, &fifoStatistics);
 static volatile uint32_t bufferOverflow;
 
 //------------------------------------------------------------------------------
@@ -143,20 +145,22 @@ void AdcInterruptHandler(void) {
     accumulator.ch7 += ADCDATA12;
     accumulator.ch8 += ADCDATA11;
     if (accumulator.numberOfSamples >= OVERSAMPLING) {
-        const FifoPacket fifoPacket = {
-            .timestamp = TimerGetTicks64(),
-            .ch1 = accumulator.ch1,
-            .ch2 = accumulator.ch2,
-            .ch3 = accumulator.ch3,
-            .ch4 = accumulator.ch4,
-            .ch5 = accumulator.ch5,
-            .ch6 = accumulator.ch6,
-            .ch7 = accumulator.ch7,
-            .ch8 = accumulator.ch8,
-        };
-        if (FifoWrite(&fifo, &fifoPacket, sizeof (fifoPacket)) != FifoResultOk) {
+        FifoPacket * const fifoPacket = FifoRecordWriteReserve(&fifo);
+        if (fifoPacket == NULL) {
             bufferOverflow++;
+        } else {
+            fifoPacket->timestamp = TimerGetTicks64();
+            fifoPacket->ch1 = accumulator.ch1;
+            fifoPacket->ch2 = accumulator.ch2;
+            fifoPacket->ch3 = accumulator.ch3;
+            fifoPacket->ch4 = accumulator.ch4;
+            fifoPacket->ch5 = accumulator.ch5;
+            fifoPacket->ch6 = accumulator.ch6;
+            fifoPacket->ch7 = accumulator.ch7;
+            fifoPacket->ch8 = accumulator.ch8;
+            FifoRecordWriteCommit(&fifo);
         }
+        EventsSet(EventsAdc);
         static const Accumulator zeros;
         accumulator = zeros;
     }
@@ -171,19 +175,21 @@ void AdcInterruptHandler(void) {
  * @return Result.
  */
 AdcResult AdcGetData(AdcData * const data) {
-    FifoPacket fifoPacket;
-    if (FifoRead(&fifo, &fifoPacket, sizeof (fifoPacket)) == 0) {
+    const FifoPacket * const fifoPacket = FifoRecordReadPeek(&fifo);
+    if (fifoPacket == NULL) {
         return AdcResultError;
     }
-    data->timestamp = fifoPacket.timestamp;
-    data->ch1 = (float) fifoPacket.ch1 * SCALING;
-    data->ch2 = (float) fifoPacket.ch2 * SCALING;
-    data->ch3 = (float) fifoPacket.ch3 * SCALING;
-    data->ch4 = (float) fifoPacket.ch4 * SCALING;
-    data->ch5 = (float) fifoPacket.ch5 * SCALING;
-    data->ch6 = (float) fifoPacket.ch6 * SCALING;
-    data->ch7 = (float) fifoPacket.ch7 * SCALING;
-    data->ch8 = (float) fifoPacket.ch8 * SCALING;
+    data->timestamp = fifoPacket->timestamp;
+    data->ch1 = (float) fifoPacket->ch1 * SCALING;
+    data->ch2 = (float) fifoPacket->ch2 * SCALING;
+    data->ch3 = (float) fifoPacket->ch3 * SCALING;
+    data->ch4 = (float) fifoPacket->ch4 * SCALING;
+    data->ch5 = (float) fifoPacket->ch5 * SCALING;
+    data->ch6 = (float) fifoPacket->ch6 * SCALING;
+    data->ch7 = (float) fifoPacket->ch7 * SCALING;
+    data->ch8 = (float) fifoPacket->ch8 * SCALING;
+    FifoStatisticsLatency(&fifoStatistics, (uint32_t) (TimerGetTicks64() - fifoPacket->timestamp));
+    FifoRecordReadRelease(&fifo);
     return AdcResultOk;
 }
 
@@ -196,5 +202,18 @@ uint32_t AdcBufferOverflow(void) {
     return __sync_lock_test_and_set(&bufferOverflow, 0);
 }
 
+/**
+ * @brief Gets the FIFO statistics. Occupancy is in packets. Latency is the
+ * time from the end of the oversampled frame to when it is read by AdcGetData.
+ * Calling this function will reset the statistics.
+ * @param statistics Statistics.
+ */
+void AdcGetFifoStatistics(FifoStatistics * const statistics) {
+    const bool interruptStatus = SYS_INT_Disable();
+    *statistics = fifoStatistics;
+    fifoStatistics = (FifoStatistics){0};
+    SYS_INT_Restore(interruptStatus);
+}
+
 //------------------------------------------------------------------------------
 // End of file
@@ -10,6 +10,7 @@
 //------------------------------------------------------------------------------
 // Includes
 
+#include "FifoStatistics.h"
 #include <stdint.h>
 
 //------------------------------------------------------------------------------
@@ -44,6 +45,7 @@ typedef enum {
 void AdcInitialise(void);
 AdcResult AdcGetData(AdcData * const data);
 uint32_t AdcBufferOverflow(void);
+void AdcGetFifoStatistics(FifoStatistics * const statistics);
 
 #endif
 
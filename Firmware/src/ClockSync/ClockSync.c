@@ -0,0 +1,101 @@
+/**
+ * @file ClockSync.c
+ * @author Seb Madgwick
+ * @brief Clock correlation using the USB start of frame. The timer is captured
+ * in the USB interrupt at the start of each frame while the messages are
+ * enabled. The capture is read on each tick. A serial accessory message
+ * pairing the frame number with the captured time is sent at the requested
+ * interval in frames (1 ms). The host may fit a mapping between device time
+ * and the host USB clock without round-trip commands.
+ *
+ * Payload:
+ * "SOF,<frame number>,<ticks>"
+ *
+ * The message timestamp is the captured time in microseconds. The frame
+ * number is 11 bits and wraps every 2048 ms. The ticks are the least
+ * significant 32 bits of the captured timer value for sub-microsecond
+ * resolution.
+ */
+
+//------------------------------------------------------------------------------
+// Includes
+
+#include "ClockSync.h"
+#include "Send/Send.h"
+#include <stdbool.h>
+#include "Timer/Timer.h"
+#include "Usb/UsbCdc.h"
+
+//------------------------------------------------------------------------------
+// Definitions
+
+/**
+ * @brief Frame number mask.
+ */
+#define FRAME_NUMBER_MASK (0x7FF)
+
+//------------------------------------------------------------------------------
+// Variables
+
+static uint32_t interval;
+static uint16_t previousFrameNumber;
+static bool previousFrameNumberValid;
+static uint32_t numberOfFrames;
+
+//------------------------------------------------------------------------------
+// Functions
+
+/**
+ * @brief Module tasks. This function should be called repeatedly within the
+ * main program loop.
+ */
+void ClockSyncTasks(void) {
+
+    // Do nothing if no new start of frame
+    UsbCdcStartOfFrame startOfFrame;
+    if (UsbCdcGetStartOfFrame(&startOfFrame) == false) {
+        return;
+    }
+
+    // Do nothing if not enabled or first frame since enabled
+    if ((interval == 0) || (previousFrameNumberValid == false)) {
+        previousFrameNumber = startOfFrame.frameNumber;
+        previousFrameNumberValid = true;
+        return;
+    }
+
+    // Do nothing if interval not elapsed
+    numberOfFrames += (startOfFrame.frameNumber - previousFrameNumber) & FRAME_NUMBER_MASK;
+    previousFrameNumber = startOfFrame.frameNumber;
+    if (numberOfFrames < interval) {
+        return;
+    }
+    numberOfFrames = 0;
+
+    // Send message
+    const uint64_t ticks = TimerGetTicks64();
+    const uint64_t capturedTicks = ticks - (uint32_t) ((uint32_t) ticks - startOfFrame.ticks);
+    SendSerialAccessory(capturedTicks, "SOF,%u,%u", (unsigned int) startOfFrame.frameNumber, (unsigned int) startOfFrame.ticks);
+}
+
+/**
+ * @brief Sets the interval. A value of 0 will disable the messages.
+ * @param frames Interval in frames.
+ */
+void ClockSyncSetInterval(const uint32_t frames) {
+    interval = frames;
+    numberOfFrames = 0;
+    previousFrameNumberValid = false; // frames not captured while disabled
+    UsbCdcSetStartOfFrameEnabled(interval != 0);
+}
+
+/**
+ * @brief Returns the interval.
+ * @return Interval in frames.
+ */
+uint32_t ClockSyncGetInterval(void) {
+    return interval;
+}
+
+//------------------------------------------------------------------------------
+// End of file
@@ -0,0 +1,25 @@
+/**
+ * @file ClockSync.h
+ * @author Seb Madgwick
+ * @brief Clock correlation using the USB start of frame.
+ */
+
+#ifndef CLOCK_SYNC_H
+#define CLOCK_SYNC_H
+
+//------------------------------------------------------------------------------
+// Includes
+
+#include <stdint.h>
+
+//------------------------------------------------------------------------------
+// Function declarations
+
+void ClockSyncTasks(void);
+void ClockSyncSetInterval(const uint32_t frames);
+uint32_t ClockSyncGetInterval(void);
+
+#endif
+
+//------------------------------------------------------------------------------
+// End of file
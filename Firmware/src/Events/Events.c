@@ -0,0 +1,90 @@
+/**
+ * @file Events.c
+ * @author Seb Madgwick
+ * @brief Event flags set by interrupts to schedule the main program loop. The
+ * main program loop only runs the tasks of pending events and waits in idle
+ * mode when there are none. The core timer generates a periodic tick event for
+ * tasks that must be polled.
+ */
+
+//------------------------------------------------------------------------------
+// Includes
+
+#include "definitions.h"
+#include "Events.h"
+
+//------------------------------------------------------------------------------
+// Definitions
+
+/**
+ * @brief Core timer ticks per tick event. The core timer increments at half
+ * the CPU clock frequency.
+ */
+#define CORE_TIMER_PERIOD ((CPU_CLOCK_FREQUENCY / 2) / EVENTS_TICK_FREQUENCY)
+
+//------------------------------------------------------------------------------
+// Variables
+
+static volatile uint32_t events;
+
+//------------------------------------------------------------------------------
+// Functions
+
+/**
+ * @brief Initialises the module. This function must only be called once, on
+ * system startup.
+ */
+void EventsInitialise(void) {
+    _CP0_SET_COMPARE(_CP0_GET_COUNT() + CORE_TIMER_PERIOD);
+    EVIC_SourceStatusClear(INT_SOURCE_CORE_TIMER);
+    EVIC_SourceEnable(INT_SOURCE_CORE_TIMER);
+}
+
+/**
+ * @brief Sets events. This function may be called from an interrupt.
+ * @param events_ Events.
+ */
+void EventsSet(const Events events_) {
+    __sync_fetch_and_or(&events, (uint32_t) events_);
+}
+
+/**
+ * @brief Returns the pending events. Calling this function will clear the
+ * events.
+ * @return Pending events.
+ */
+Events EventsGet(void) {
+    return (Events) __sync_lock_test_and_set(&events, 0);
+}
+
+/**
+ * @brief Waits in idle mode until an interrupt if there are no pending events.
+ * Interrupts are disabled while checking for events so that an event set
+ * between the check and the WAIT instruction is not missed. The CPU exits idle
+ * mode on a pending interrupt even when interrupts are disabled, and the
+ * interrupt is serviced once interrupts are enabled.
+ */
+void EventsWait(void) {
+    const bool interruptStatus = SYS_INT_Disable();
+    if (events == 0) {
+        __asm__ volatile ("wait");
+    }
+    SYS_INT_Restore(interruptStatus);
+}
+
+/**
+ * @brief Core timer interrupt handler. This function should be called by the
+ * ISR implementation generated by MPLAB Harmony.
+ */
+void EventsCoreTimerInterruptHandler(void) {
+    uint32_t compare = _CP0_GET_COMPARE() + CORE_TIMER_PERIOD;
+    if ((int32_t) (compare - _CP0_GET_COUNT()) <= 0) {
+        compare = _CP0_GET_COUNT() + CORE_TIMER_PERIOD; // skip missed ticks
+    }
+    _CP0_SET_COMPARE(compare); // clears interrupt condition
+    EVIC_SourceStatusClear(INT_SOURCE_CORE_TIMER);
+    EventsSet(EventsTick);
+}
+
+//------------------------------------------------------------------------------
+// End of file
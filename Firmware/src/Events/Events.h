@@ -0,0 +1,45 @@
+/**
+ * @file Events.h
+ * @author Seb Madgwick
+ * @brief Event flags set by interrupts to schedule the main program loop.
+ */
+
+#ifndef EVENTS_H
+#define EVENTS_H
+
+//------------------------------------------------------------------------------
+// Includes
+
+#include <stdint.h>
+
+//------------------------------------------------------------------------------
+// Definitions
+
+/**
+ * @brief Tick frequency in Hz.
+ */
+#define EVENTS_TICK_FREQUENCY (1000)
+
+/**
+ * @brief Events. Each event is a bit so that events may be combined.
+ */
+typedef enum {
+    EventsTick = 1 << 0,
+    EventsAdc = 1 << 1,
+    EventsUsb = 1 << 2,
+    EventsThroughput = 1 << 3,
+} Events;
+
+//------------------------------------------------------------------------------
+// Function declarations
+
+void EventsInitialise(void);
+void EventsSet(const Events events_);
+Events EventsGet(void);
+void EventsWait(void);
+void EventsCoreTimerInterruptHandler(void);
+
+#endif
+
+//------------------------------------------------------------------------------
+// End of file
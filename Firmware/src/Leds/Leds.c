@@ -10,7 +10,6 @@
 #include "Leds.h"
 #include "NeoPixels/NeoPixels1.h"
 #include "Periodic.h"
-#include <stdbool.h>
 
 //------------------------------------------------------------------------------
 // Definitions
@@ -41,9 +40,7 @@ const LedsColour ledsColourMagenta = {.rgb = 0xFF00FF};
 const LedsColour ledsColourWhite = {.rgb = 0xFFFFFF};
 const LedsColour ledsColourBlack = {.rgb = 0x000000};
 
-static bool blinkPending;
-static LedsChannel blinkChannel;
-static LedsColour blinkColour;
+static uint32_t blink; // channel in the unused most significant byte of the colour, 0 if no blink pending
 static uint64_t strobeTimeout;
 
 //------------------------------------------------------------------------------
@@ -69,9 +66,9 @@ void LedsTasks(void) {
     }
 
     // Blink
-    if (blinkPending) {
-        SetLeds(blinkChannel, blinkColour, BrightnessHigh);
-        blinkPending = false;
+    const uint32_t blink_ = __atomic_exchange_n(&blink, 0, __ATOMIC_RELAXED);
+    if (blink_ != 0) {
+        SetLeds((LedsChannel) (blink_ >> 24), (LedsColour) {.rgb = blink_ & 0x00FFFFFF}, BrightnessHigh);
         return;
     }
 
@@ -100,12 +97,13 @@ static inline __attribute__((always_inline)) void SetLeds(const LedsChannel chan
 }
 
 /**
- * @brief Blinks the LEDs.
+ * @brief Blinks the LEDs. The channel and colour are stored as a single word
+ * so that this function may be called from interrupts.
+ * @param channel Channel.
+ * @param colour Colour.
  */
 void LedsBlink(const LedsChannel channel, const LedsColour colour) {
-    blinkPending = true;
-    blinkChannel = channel;
-    blinkColour = colour;
+    __atomic_store_n(&blink, ((uint32_t) channel << 24) | (colour.rgb & 0x00FFFFFF), __ATOMIC_RELAXED);
 }
 
 /**
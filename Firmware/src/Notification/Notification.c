@@ -33,9 +33,13 @@ void NotificationTasks(void) {
     }
 
     // Send buffer overflow
-    const uint32_t bufferOverflow = SendBufferOverflow();
-    if (bufferOverflow > 0) {
-        SendError("USB buffer overflow. %u bytes lost.", bufferOverflow);
+    const uint32_t priorityBufferOverflow = SendBufferOverflow(UsbCdcQueuePriority);
+    if (priorityBufferOverflow > 0) {
+        SendError("USB priority buffer overflow. %u messages lost.", priorityBufferOverflow);
+    }
+    const uint32_t bulkBufferOverflow = SendBufferOverflow(UsbCdcQueueBulk);
+    if (bulkBufferOverflow > 0) {
+        SendError("USB bulk buffer overflow. %u messages lost.", bulkBufferOverflow);
     }
 }
 
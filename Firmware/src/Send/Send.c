@@ -1,12 +1,21 @@
 /**
  * @file Send.c
  * @author Seb Madgwick
- * @brief Message sending.
+ * @brief Message sending. Messages may be sent from the main program loop and
+ * from interrupts. Space for each message is reserved in the USB write queue
+ * with interrupts disabled, the message is encoded directly into this space
+ * with interrupts enabled, and the message is then committed with interrupts
+ * disabled. A message sent by an interrupt while another message is being
+ * encoded is reserved after it. Interrupts are strictly nested so reservations
+ * are committed in reverse order. Committed messages are moved down over the
+ * unused space of the enclosing reservation and written to the queue together
+ * when the outermost reservation is committed.
  */
 
 //------------------------------------------------------------------------------
 // Includes
 
+#include "definitions.h"
 #include "Leds/Leds.h"
 #include "Send.h"
 #include <stdarg.h>
@@ -14,19 +23,63 @@
 #include <string.h>
 #include "Timer/Timer.h"
 #include "Usb/UsbCdc.h"
+#include "Ximu3Device/x-IMU3-Device/Ascii.h"
+#include "Ximu3Device/x-IMU3-Device/Binary.h"
 #include "Ximu3Device/x-IMU3-Device/Ximu3.h"
 
+//------------------------------------------------------------------------------
+// Definitions
+
+/**
+ * @brief Maximum size of a formatted string, including the null character.
+ * Longer strings are truncated.
+ */
+#define MAX_STRING_SIZE (256)
+
+/**
+ * @brief Maximum size of a binary message, including the byte stuffing of the
+ * timestamp and the payload.
+ */
+#define MAX_BINARY_MESSAGE_SIZE(numberOfBytes) (1 + (2 * (sizeof (uint64_t) + (numberOfBytes))) + 1)
+
+/**
+ * @brief Maximum size of a message containing a formatted string. The ASCII
+ * message is smaller than the binary message.
+ */
+#define MAX_FORMATTED_MESSAGE_SIZE MAX_BINARY_MESSAGE_SIZE(MAX_STRING_SIZE - 1)
+
+/**
+ * @brief Reservation.
+ */
+typedef struct {
+    uint8_t* destination;
+    size_t offset;
+    size_t size;
+} Reservation;
+
+/**
+ * @brief Queue. The reserved size includes messages of nested reservations
+ * that have been committed but not yet written to the queue.
+ */
+typedef struct {
+    size_t reservedSize;
+    unsigned int numberOfReservations;
+} Queue;
+
 //------------------------------------------------------------------------------
 // Function declarations
 
-static void SendDataMessage(const void* const data, const size_t numberOfBytes);
-static void SendDataMessagePriority(const void* const data, const size_t numberOfBytes);
-static inline __attribute__((always_inline)) size_t Write(const void* const data, const size_t numberOfBytes, const bool priority);
+static size_t FormatBinary(void* const destination, const size_t destinationSize, const char character, const uint64_t timestamp, const char* format, va_list arguments);
+static size_t FormatAscii(void* const destination, const size_t destinationSize, const char character, const uint64_t timestamp, const char* format, va_list arguments);
+static void FormatString(void* const destination, const size_t destinationSize, size_t * const destinationIndex, const char* format, va_list arguments);
+static bool Reserve(const UsbCdcQueue queue, const size_t maxSize, Reservation * const reservation);
+static bool Commit(const UsbCdcQueue queue, const Reservation * const reservation, size_t messageSize);
 
 //------------------------------------------------------------------------------
 // Variables
 
-static size_t bufferOverflow;
+static Queue queues[] = {[UsbCdcQueuePriority] = {0}, [UsbCdcQueueBulk] = {0}};
+static size_t bufferOverflow[] = {[UsbCdcQueuePriority] = 0, [UsbCdcQueueBulk] = 0};
 
 //------------------------------------------------------------------------------
 // Functions
@@ -38,23 +91,35 @@ static size_t bufferOverflow;
  * @param ... Arguments.
  */
 void SendSerialAccessory(const uint64_t timestamp, const char* format, ...) {
-
-    // Create string
-    char string[256];
+    Reservation reservation;
+    if (Reserve(UsbCdcQueueBulk, MAX_FORMATTED_MESSAGE_SIZE, &reservation) == false) {
+        return;
+    }
     va_list arguments;
     va_start(arguments, format);
-    vsnprintf(string, sizeof (string), format, arguments);
+    const size_t messageSize = FormatBinary(reservation.destination, reservation.size, 'S', timestamp / TIMER_TICKS_PER_MICROSECOND, format, arguments);
     va_end(arguments);
+    Commit(UsbCdcQueueBulk, &reservation, messageSize);
+}
 
-    // Send message
+/**
+ * @brief Sends serial accessory message containing data.
+ * @param timestamp Timestamp.
+ * @param data Data.
+ * @param numberOfBytes Number of bytes.
+ * @return True if the message was written to the USB write buffer.
+ */
+bool SendSerialAccessoryData(const uint64_t timestamp, const void* const data, const size_t numberOfBytes) {
+    Reservation reservation;
+    if (Reserve(UsbCdcQueueBulk, MAX_BINARY_MESSAGE_SIZE(numberOfBytes), &reservation) == false) {
+        return false;
+    }
     const Ximu3DataSerialAccessory ximu3Data = {
         .timestamp = timestamp / TIMER_TICKS_PER_MICROSECOND,
-        .data = (uint8_t*) string,
-        .numberOfBytes = strlen(string),
+        .data = (const uint8_t*) data,
+        .numberOfBytes = numberOfBytes,
     };
-    char message[256];
-    const size_t messageSize = Ximu3DataSerialAccessoryBinary(message, sizeof (message), &ximu3Data);
-    SendDataMessage(message, messageSize);
+    return Commit(UsbCdcQueueBulk, &reservation, Ximu3DataSerialAccessoryBinary(reservation.destination, reservation.size, &ximu3Data));
 }
 
 /**
@@ -63,22 +128,16 @@ void SendSerialAccessory(const uint64_t timestamp, const char* format, ...) {
  * @param ... Arguments.
  */
 void SendNotification(const char* format, ...) {
-
-    // Create string
-    char string[256];
+    const uint64_t timestamp = TimerGetTicks64() / TIMER_TICKS_PER_MICROSECOND;
+    Reservation reservation;
+    if (Reserve(UsbCdcQueuePriority, MAX_FORMATTED_MESSAGE_SIZE, &reservation) == false) {
+        return;
+    }
     va_list arguments;
     va_start(arguments, format);
-    vsnprintf(string, sizeof (string), format, arguments);
+    const size_t messageSize = FormatBinary(reservation.destination, reservation.size, 'N', timestamp, format, arguments);
     va_end(arguments);
-
-    // Send message
-    const Ximu3DataNotification ximu3Data = {
-        .timestamp = TimerGetTicks64() / TIMER_TICKS_PER_MICROSECOND,
-        .string = string
-    };
-    uint8_t message[128];
-    const size_t messageSize = Ximu3DataNotificationBinary(message, sizeof (message), &ximu3Data);
-    SendDataMessagePriority(message, messageSize);
+    Commit(UsbCdcQueuePriority, &reservation, messageSize);
 }
 
 /**
@@ -88,82 +147,181 @@ void SendNotification(const char* format, ...) {
  */
 void SendError(const char* format, ...) {
 
-    // Create string
-    char string[256];
-    va_list arguments;
-    va_start(arguments, format);
-    vsnprintf(string, sizeof (string), format, arguments);
-    va_end(arguments);
-
     // Send message
-    const Ximu3DataError ximu3Data = {
-        .timestamp = TimerGetTicks64() / TIMER_TICKS_PER_MICROSECOND,
-        .string = string
-    };
-    uint8_t message[128];
-    const size_t messageSize = Ximu3DataErrorAscii(message, sizeof (message), &ximu3Data);
-    SendDataMessagePriority(message, messageSize);
+    const uint64_t timestamp = TimerGetTicks64() / TIMER_TICKS_PER_MICROSECOND;
+    Reservation reservation;
+    if (Reserve(UsbCdcQueuePriority, MAX_FORMATTED_MESSAGE_SIZE, &reservation)) {
+        va_list arguments;
+        va_start(arguments, format);
+        const size_t messageSize = FormatAscii(reservation.destination, reservation.size, 'F', timestamp, format, arguments);
+        va_end(arguments);
+        Commit(UsbCdcQueuePriority, &reservation, messageSize);
+    }
 
     // Blink LED
     LedsBlink(LedsChannelAll, ledsColourRed);
 }
 
 /**
- * @brief Sends data message.
+ * @brief Sends response to USB.
  * @param data Data.
  * @param numberOfBytes Number of bytes.
  */
-static void SendDataMessage(const void* const data, const size_t numberOfBytes) {
-    bufferOverflow += Write(data, numberOfBytes, false);
+void SendResponse(const void* const data, const size_t numberOfBytes) {
+    Reservation reservation;
+    if (Reserve(UsbCdcQueuePriority, numberOfBytes, &reservation) == false) {
+        return;
+    }
+    if (numberOfBytes <= reservation.size) {
+        memcpy(reservation.destination, data, numberOfBytes);
+    }
+    Commit(UsbCdcQueuePriority, &reservation, numberOfBytes);
 }
 
 /**
- * @brief Sends data message with priority.
- * @param data Data.
- * @param numberOfBytes Number of bytes.
+ * @brief Writes a binary message containing a formatted string. Equivalent to
+ * Ximu3DataNotificationBinary for a string formatted directly into the
+ * destination and byte stuffed in place.
+ * @param destination Destination.
+ * @param destinationSize Destination size.
+ * @param character First character of equivalent ASCII data message.
+ * @param timestamp Timestamp.
+ * @param format Format.
+ * @param arguments Arguments.
+ * @return Message size. Greater than the destination size if truncated.
  */
-static void SendDataMessagePriority(const void* const data, const size_t numberOfBytes) {
-    bufferOverflow += Write(data, numberOfBytes, true);
+static size_t FormatBinary(void* const destination, const size_t destinationSize, const char character, const uint64_t timestamp, const char* format, va_list arguments) {
+    size_t destinationIndex = 0;
+    BinaryFirstByte(destination, destinationSize, &destinationIndex, character);
+    BinaryTimestamp(destination, destinationSize, &destinationIndex, timestamp);
+    const size_t stringIndex = destinationIndex;
+    FormatString(destination, destinationSize, &destinationIndex, format, arguments);
+    BinaryStuff(destination, destinationSize, &destinationIndex, stringIndex);
+    BinaryTermination(destination, destinationSize, &destinationIndex);
+    return destinationIndex;
 }
 
 /**
- * @brief Sends response to USB.
- * @param data Data.
- * @param numberOfBytes Number of bytes.
+ * @brief Writes an ASCII message containing a formatted string. Equivalent to
+ * Ximu3DataErrorAscii for a string formatted directly into the destination.
+ * @param destination Destination.
+ * @param destinationSize Destination size.
+ * @param character First character.
+ * @param timestamp Timestamp.
+ * @param format Format.
+ * @param arguments Arguments.
+ * @return Message size. Greater than the destination size if truncated.
  */
-void SendResponse(const void* const data, const size_t numberOfBytes) {
-    bufferOverflow += Write(data, numberOfBytes, true);
+static size_t FormatAscii(void* const destination, const size_t destinationSize, const char character, const uint64_t timestamp, const char* format, va_list arguments) {
+    size_t destinationIndex = 0;
+    AsciiFirstByte(destination, destinationSize, &destinationIndex, character);
+    AsciiTimestamp(destination, destinationSize, &destinationIndex, timestamp);
+    AsciiCharacter(destination, destinationSize, &destinationIndex, ',');
+    FormatString(destination, destinationSize, &destinationIndex, format, arguments);
+    AsciiTermination(destination, destinationSize, &destinationIndex);
+    return destinationIndex;
 }
 
 /**
- * @brief Writes data and returns number of bytes lost due to buffer overflow.
- * @param data Data.
- * @param numberOfBytes Number of bytes.
- * @param priority True to write with priority.
- * @return Number of samples lost due to buffer overflow.
+ * @brief Writes a formatted string. The string is truncated to
+ * MAX_STRING_SIZE - 1 characters. The string is only considered truncated by
+ * the destination if it is shorter than this.
+ * @param destination Destination.
+ * @param destinationSize Destination size.
+ * @param destinationIndex Destination index.
+ * @param format Format.
+ * @param arguments Arguments.
+ */
+static void FormatString(void* const destination, const size_t destinationSize, size_t * const destinationIndex, const char* format, va_list arguments) {
+    if (*destinationIndex >= destinationSize) {
+        *destinationIndex = destinationSize + 1; // indicate truncation
+        return;
+    }
+    const size_t available = destinationSize - *destinationIndex;
+    const size_t size = available < MAX_STRING_SIZE ? available : MAX_STRING_SIZE;
+    const int length = vsnprintf(&((char*) destination)[*destinationIndex], size, format, arguments);
+    if ((length < 0) || (((size_t) length >= size) && (size < MAX_STRING_SIZE))) {
+        *destinationIndex = destinationSize + 1; // indicate truncation
+        return;
+    }
+    *destinationIndex += (size_t) length < size ? (size_t) length : (size - 1);
+}
+
+/**
+ * @brief Reserves space in a USB write queue for a message to be written
+ * directly by the encoder. The space is limited to the maximum size of the
+ * message so that space remains for messages sent by interrupts before the
+ * message is committed.
+ * @param queue Queue.
+ * @param maxSize Maximum message size.
+ * @param reservation Reservation.
+ * @return True if successful. False if the port of the queue is not open or
+ * there is no space available.
  */
-static inline __attribute__((always_inline)) size_t Write(const void* const data, const size_t numberOfBytes, const bool priority) {
-    if (UsbCdcPortOpen() == false) {
-        return 0;
+static bool Reserve(const UsbCdcQueue queue, const size_t maxSize, Reservation * const reservation) {
+    if (UsbCdcPortOpen(queue) == false) {
+        return false;
+    }
+    const bool interruptStatus = SYS_INT_Disable();
+    Queue * const reservationQueue = &queues[queue];
+    size_t available;
+    uint8_t * const destination = UsbCdcWriteReserve(queue, &available);
+    if (available <= reservationQueue->reservedSize) {
+        bufferOverflow[queue]++;
+        SYS_INT_Restore(interruptStatus);
+        return false;
     }
-    if ((priority == false) && (UsbCdcAvailableWrite() < (numberOfBytes + 1024))) {
-        return numberOfBytes;
+    available -= reservationQueue->reservedSize;
+    reservation->destination = &destination[reservationQueue->reservedSize];
+    reservation->offset = reservationQueue->reservedSize;
+    reservation->size = available < maxSize ? available : maxSize;
+    reservationQueue->reservedSize += reservation->size;
+    reservationQueue->numberOfReservations++;
+    SYS_INT_Restore(interruptStatus);
+    return true;
+}
+
+/**
+ * @brief Commits message written to reserved space. The message is discarded
+ * if it was truncated. A message that exactly fills the space is committed.
+ * Messages of nested reservations committed after the reservation was made
+ * are moved down to follow the message. The queue is written to when the
+ * outermost reservation is committed.
+ * @param queue Queue.
+ * @param reservation Reservation.
+ * @param messageSize Message size. Greater than the reservation size if
+ * truncated.
+ * @return True if the message was committed.
+ */
+static bool Commit(const UsbCdcQueue queue, const Reservation * const reservation, size_t messageSize) {
+    const bool interruptStatus = SYS_INT_Disable();
+    Queue * const reservationQueue = &queues[queue];
+    const bool committed = (messageSize != 0) && (messageSize <= reservation->size);
+    if (committed == false) {
+        bufferOverflow[queue]++;
+        messageSize = 0;
     }
-    if (UsbCdcWrite(data, numberOfBytes) != FifoResultOk) {
-        return numberOfBytes;
+    const size_t nestedSize = reservationQueue->reservedSize - (reservation->offset + reservation->size);
+    memmove(&reservation->destination[messageSize], &reservation->destination[reservation->size], nestedSize);
+    reservationQueue->reservedSize = reservation->offset + messageSize + nestedSize;
+    if (--reservationQueue->numberOfReservations == 0) {
+        if (reservationQueue->reservedSize > 0) {
+            UsbCdcWriteCommit(queue, reservationQueue->reservedSize);
+        }
+        reservationQueue->reservedSize = 0;
     }
-    return 0;
+    SYS_INT_Restore(interruptStatus);
+    return committed;
 }
 
 /**
- * @brief Returns the number of bytes lost due to buffer overflow. Calling
- * this function will reset the value.
- * @return Number of samples lost due to buffer overflow.
+ * @brief Returns the number of messages lost due to buffer overflow of a USB
+ * write queue. Calling this function will reset the value.
+ * @param queue Queue.
+ * @return Number of messages lost due to buffer overflow.
  */
-size_t SendBufferOverflow() {
-    const size_t bufferOverflow_ = bufferOverflow;
-    bufferOverflow = 0;
-    return bufferOverflow_;
+size_t SendBufferOverflow(const UsbCdcQueue queue) {
+    return __atomic_exchange_n(&bufferOverflow[queue], 0, __ATOMIC_RELAXED);
 }
 
 //------------------------------------------------------------------------------
@@ -10,17 +10,20 @@
 //------------------------------------------------------------------------------
 // Includes
 
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
+#include "Usb/UsbCdc.h"
 
 //------------------------------------------------------------------------------
 // Function declarations
 
 void SendSerialAccessory(const uint64_t timestamp, const char* format, ...);
+bool SendSerialAccessoryData(const uint64_t timestamp, const void* const data, const size_t numberOfBytes);
 void SendNotification(const char* format, ...);
 void SendError(const char* format, ...);
 void SendResponse(const void* const data, const size_t numberOfBytes);
-size_t SendBufferOverflow(void);
+size_t SendBufferOverflow(const UsbCdcQueue queue);
 
 #endif
 
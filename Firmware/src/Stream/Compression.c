@@ -0,0 +1,225 @@
+/**
+ * @file Compression.c
+ * @author Seb Madgwick
+ * @brief Lossless delta compression of sensor frames. Values are quantised to
+ * the 6 decimal places of the ASCII stream, predicted from the previous frame,
+ * and the differences written as zigzag varints. A message that starts with a
+ * keyframe can be decoded without any previous messages. This file has no
+ * device dependencies so that the decoder may be compiled for the host.
+ *
+ * Message:
+ * Byte 0     Sequence number, incremented for each message
+ * Byte 1     Flags, bit 0 set if the first frame is a keyframe
+ * Byte 2...  Frames
+ *
+ * Frame:
+ * Varint     Microseconds since previous frame, or since message timestamp
+ * Varint x8  64-bit zigzag difference from the previous frame, or from zero
+ *            for a keyframe
+ *
+ * Quantised values are 64-bit so that every value that "%f" writes with the
+ * ASCII fast path, magnitudes up to 9e12, is represented exactly.
+ */
+
+//------------------------------------------------------------------------------
+// Includes
+
+#include "Compression.h"
+#include <math.h>
+
+//------------------------------------------------------------------------------
+// Definitions
+
+/**
+ * @brief Keyframe flag.
+ */
+#define FLAG_KEYFRAME (1 << 0)
+
+//------------------------------------------------------------------------------
+// Function declarations
+
+static inline void WriteVarint(void* const destination, const size_t destinationSize, size_t * const destinationIndex, uint64_t value);
+static inline CompressionResult ReadVarint(const uint8_t * const source, const size_t sourceSize, size_t * const sourceIndex, uint64_t * const value);
+
+//------------------------------------------------------------------------------
+// Functions
+
+/**
+ * @brief Returns the value quantised to 6 decimal places. The value is scaled
+ * exactly in double precision and rounded to nearest, ties to even, so that
+ * the result is identical to the value written by "%f". The result is
+ * saturated for magnitudes of 9.2e12 or more and for infinity. NaN is
+ * quantised to 0.
+ * @param value Value.
+ * @return Quantised value.
+ */
+int64_t CompressionQuantise(const float value) {
+    if (isnan(value)) {
+        return 0;
+    }
+    const double scaled = (double) value * (double) COMPRESSION_SCALE; // exact for float values
+    if (scaled >= 9223372036854775808.0) { // INT64_MAX is not representable as a double
+        return INT64_MAX;
+    }
+    if (scaled <= (double) INT64_MIN) {
+        return INT64_MIN;
+    }
+    double integer = floor(scaled);
+    const double remainder = scaled - integer;
+    if ((remainder > 0.5) || ((remainder == 0.5) && (fmod(integer, 2.0) != 0.0))) {
+        integer += 1.0;
+    }
+    return (int64_t) integer;
+}
+
+/**
+ * @brief Writes the message header. Must be called at the start of each
+ * message, before the frames.
+ * @param compression Compression structure.
+ * @param destination Destination.
+ * @param destinationSize Destination size.
+ * @param destinationIndex Destination index.
+ * @param keyframe True if the first frame should be a keyframe.
+ */
+void CompressionEncodeHeader(Compression * const compression, void* const destination, const size_t destinationSize, size_t * const destinationIndex, const bool keyframe) {
+    if ((*destinationIndex + COMPRESSION_HEADER_SIZE) > destinationSize) {
+        *destinationIndex = destinationSize + 1; // indicate truncation
+        return;
+    }
+    ((uint8_t*) destination)[(*destinationIndex)++] = compression->sequence++;
+    ((uint8_t*) destination)[(*destinationIndex)++] = keyframe ? FLAG_KEYFRAME : 0;
+    if (keyframe) {
+        for (int channel = 0; channel < COMPRESSION_NUMBER_OF_CHANNELS; channel++) {
+            compression->previous[channel] = 0;
+        }
+    }
+}
+
+/**
+ * @brief Writes a frame.
+ * @param compression Compression structure.
+ * @param destination Destination.
+ * @param destinationSize Destination size.
+ * @param destinationIndex Destination index.
+ * @param microseconds Microseconds since previous frame, or since message
+ * timestamp for the first frame.
+ * @param values Values. COMPRESSION_NUMBER_OF_CHANNELS elements.
+ */
+void CompressionEncodeFrame(Compression * const compression, void* const destination, const size_t destinationSize, size_t * const destinationIndex, const uint32_t microseconds, const float * const values) {
+    WriteVarint(destination, destinationSize, destinationIndex, microseconds);
+    for (int channel = 0; channel < COMPRESSION_NUMBER_OF_CHANNELS; channel++) {
+        const int64_t value = CompressionQuantise(values[channel]);
+        const uint64_t difference = (uint64_t) value - (uint64_t) compression->previous[channel]; // wraparound is intentional
+        WriteVarint(destination, destinationSize, destinationIndex, (difference << 1) ^ (uint64_t) -(int64_t) (difference >> 63));
+        compression->previous[channel] = value;
+    }
+}
+
+/**
+ * @brief Decodes a message. Messages that follow a lost message are rejected
+ * until the next keyframe.
+ * @param compression Compression structure.
+ * @param message Message.
+ * @param messageSize Message size.
+ * @param frames Frames.
+ * @param maxNumberOfFrames Maximum number of frames.
+ * @param numberOfFrames Number of frames.
+ * @return Result.
+ */
+CompressionResult CompressionDecode(Compression * const compression, const void* const message, const size_t messageSize, CompressionFrame * const frames, const size_t maxNumberOfFrames, size_t * const numberOfFrames) {
+    const uint8_t * const bytes = (const uint8_t*) message;
+    *numberOfFrames = 0;
+
+    // Header
+    if (messageSize < COMPRESSION_HEADER_SIZE) {
+        return CompressionResultError;
+    }
+    const uint8_t sequence = bytes[0];
+    const bool keyframe = (bytes[1] & FLAG_KEYFRAME) != 0;
+    if ((compression->synchronised == false) || (sequence != compression->sequence)) {
+        compression->synchronised = keyframe;
+    }
+    compression->sequence = sequence + 1;
+    if (compression->synchronised == false) {
+        return CompressionResultError;
+    }
+    if (keyframe) {
+        for (int channel = 0; channel < COMPRESSION_NUMBER_OF_CHANNELS; channel++) {
+            compression->previous[channel] = 0;
+        }
+    }
+
+    // Frames
+    size_t index = COMPRESSION_HEADER_SIZE;
+    while (index < messageSize) {
+        if (*numberOfFrames >= maxNumberOfFrames) {
+            return CompressionResultError;
+        }
+        CompressionFrame * const frame = &frames[*numberOfFrames];
+        uint64_t microseconds;
+        if ((ReadVarint(bytes, messageSize, &index, &microseconds) != CompressionResultOk) || (microseconds > UINT32_MAX)) {
+            compression->synchronised = false;
+            return CompressionResultError;
+        }
+        frame->microseconds = (uint32_t) microseconds;
+        for (int channel = 0; channel < COMPRESSION_NUMBER_OF_CHANNELS; channel++) {
+            uint64_t zigzag;
+            if (ReadVarint(bytes, messageSize, &index, &zigzag) != CompressionResultOk) {
+                compression->synchronised = false;
+                return CompressionResultError;
+            }
+            const uint64_t difference = (zigzag >> 1) ^ (uint64_t) -(int64_t) (zigzag & 1);
+            compression->previous[channel] = (int64_t) ((uint64_t) compression->previous[channel] + difference);
+            frame->values[channel] = compression->previous[channel];
+        }
+        (*numberOfFrames)++;
+    }
+    return CompressionResultOk;
+}
+
+/**
+ * @brief Writes an unsigned varint. Each byte contains 7 bits of the value,
+ * least significant first, with the most significant bit set if more bytes
+ * follow.
+ * @param destination Destination.
+ * @param destinationSize Destination size.
+ * @param destinationIndex Destination index.
+ * @param value Value.
+ */
+static inline void WriteVarint(void* const destination, const size_t destinationSize, size_t * const destinationIndex, uint64_t value) {
+    do {
+        if (*destinationIndex >= destinationSize) {
+            *destinationIndex = destinationSize + 1; // indicate truncation
+            return;
+        }
+        const uint8_t byte = value & 0x7F;
+        value >>= 7;
+        ((uint8_t*) destination)[(*destinationIndex)++] = value == 0 ? byte : (byte | 0x80);
+    } while (value != 0);
+}
+
+/**
+ * @brief Reads an unsigned varint.
+ * @param source Source.
+ * @param sourceSize Source size.
+ * @param sourceIndex Source index.
+ * @param value Value.
+ * @return Result.
+ */
+static inline CompressionResult ReadVarint(const uint8_t * const source, const size_t sourceSize, size_t * const sourceIndex, uint64_t * const value) {
+    *value = 0;
+    for (int shift = 0; shift < 70; shift += 7) {
+        if (*sourceIndex >= sourceSize) {
+            return CompressionResultError;
+        }
+        const uint8_t byte = source[(*sourceIndex)++];
+        *value |= (uint64_t) (byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return CompressionResultOk;
+        }
+    }
+    return CompressionResultError;
+}
+
+//------------------------------------------------------------------------------
+// End of file
@@ -0,0 +1,80 @@
+/**
+ * @file Compression.h
+ * @author Seb Madgwick
+ * @brief Lossless delta compression of sensor frames. Values are quantised to
+ * the 6 decimal places of the ASCII stream, predicted from the previous frame,
+ * and the differences written as zigzag varints. A message that starts with a
+ * keyframe can be decoded without any previous messages. This file has no
+ * device dependencies so that the decoder may be compiled for the host.
+ */
+
+#ifndef COMPRESSION_H
+#define COMPRESSION_H
+
+//------------------------------------------------------------------------------
+// Includes
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+//------------------------------------------------------------------------------
+// Definitions
+
+/**
+ * @brief Number of channels per frame.
+ */
+#define COMPRESSION_NUMBER_OF_CHANNELS (8)
+
+/**
+ * @brief Quantised value per unit. Equivalent to 6 decimal places.
+ */
+#define COMPRESSION_SCALE (1000000)
+
+/**
+ * @brief Maximum number of bytes per frame.
+ */
+#define COMPRESSION_MAX_FRAME_SIZE (5 + (10 * COMPRESSION_NUMBER_OF_CHANNELS))
+
+/**
+ * @brief Message header size.
+ */
+#define COMPRESSION_HEADER_SIZE (2)
+
+/**
+ * @brief Compression structure. All structure members are private.
+ */
+typedef struct {
+    int64_t previous[COMPRESSION_NUMBER_OF_CHANNELS];
+    uint8_t sequence;
+    bool synchronised;
+} Compression;
+
+/**
+ * @brief Decoded frame.
+ */
+typedef struct {
+    uint32_t microseconds; // since previous frame, or since message timestamp for first frame
+    int64_t values[COMPRESSION_NUMBER_OF_CHANNELS]; // divide by COMPRESSION_SCALE
+} CompressionFrame;
+
+/**
+ * @brief Result.
+ */
+typedef enum {
+    CompressionResultOk,
+    CompressionResultError,
+} CompressionResult;
+
+//------------------------------------------------------------------------------
+// Function declarations
+
+int64_t CompressionQuantise(const float value);
+void CompressionEncodeHeader(Compression * const compression, void* const destination, const size_t destinationSize, size_t * const destinationIndex, const bool keyframe);
+void CompressionEncodeFrame(Compression * const compression, void* const destination, const size_t destinationSize, size_t * const destinationIndex, const uint32_t microseconds, const float * const values);
+CompressionResult CompressionDecode(Compression * const compression, const void* const message, const size_t messageSize, CompressionFrame * const frames, const size_t maxNumberOfFrames, size_t * const numberOfFrames);
+
+#endif
+
+//------------------------------------------------------------------------------
+// End of file
@@ -0,0 +1,283 @@
+/**
+ * @file Stream.c
+ * @author Seb Madgwick
+ * @brief Sensor data stream. Each frame is sent as a line of comma-separated
+ * channel values within a serial accessory message. Consecutive frames may be
+ * batched into a single message. While batching is enabled, including adaptive
+ * batching, each line is prefixed by the number of microseconds since the
+ * previous frame, or since the message timestamp for the first line, so that
+ * every line has the same number of columns regardless of the batch size.
+ * Frames may instead be compressed, in which case the message contains the
+ * binary encoding described in Compression.c. Frames are decimated while the
+ * host is slow to read so that the stream degrades smoothly rather than losing
+ * whole messages. Each change in decimation is announced by a notification
+ * message.
+ */
+
+//------------------------------------------------------------------------------
+// Includes
+
+#include "Compression.h"
+#include "Config.h"
+#include "Send/Send.h"
+#include "Stream.h"
+#include "Timer/Timer.h"
+#include "Usb/UsbCdc.h"
+#include "Ximu3Device/x-IMU3-Device/Ascii.h"
+
+//------------------------------------------------------------------------------
+// Definitions
+
+/**
+ * @brief Maximum number of bytes per line.
+ */
+#define MAX_LINE_LENGTH (96)
+
+#if (STREAM_MAX_BATCH_SIZE * MAX_LINE_LENGTH) < (COMPRESSION_HEADER_SIZE + (STREAM_MAX_BATCH_SIZE * COMPRESSION_MAX_FRAME_SIZE))
+#error "Payload must not be less than the size of a message of compressed frames."
+#endif
+
+/**
+ * @brief USB write buffer backlog that will increase the adaptive batch size
+ * by one.
+ */
+#define ADAPTIVE_BACKLOG_PER_FRAME (512)
+
+/**
+ * @brief Maximum number of compressed frames between keyframes.
+ */
+#define KEYFRAME_INTERVAL (375)
+
+/**
+ * @brief Maximum decimation of frames.
+ */
+#define MAX_DECIMATION (16)
+
+/**
+ * @brief USB write buffer backlog above which the decimation is increased.
+ */
+#define DECIMATION_INCREASE_BACKLOG ((3 * USB_CDC_WRITE_BUFFER_SIZE) / 4)
+
+/**
+ * @brief USB write buffer backlog below which the decimation is decreased.
+ */
+#define DECIMATION_DECREASE_BACKLOG (USB_CDC_WRITE_BUFFER_SIZE / 4)
+
+/**
+ * @brief Minimum period between increases in decimation. Allows the effect of
+ * each increase to be seen in the backlog.
+ */
+#define DECIMATION_INCREASE_PERIOD (100 * TIMER_TICKS_PER_MILLISECOND)
+
+/**
+ * @brief Period that the backlog must remain low before the decimation is
+ * decreased.
+ */
+#define DECIMATION_DECREASE_PERIOD (2 * TIMER_TICKS_PER_SECOND)
+
+//------------------------------------------------------------------------------
+// Function declarations
+
+static bool Decimate(const uint64_t ticks);
+static void SetDecimation(const uint32_t decimation_, const uint64_t ticks);
+static void WriteLine(const uint64_t microseconds, const float * const values);
+static void WriteCompressed(const uint64_t microseconds, const float * const values);
+static uint32_t AdaptiveBatchSize(void);
+
+//------------------------------------------------------------------------------
+// Variables
+
+static uint32_t batchSize = 1;
+static uint32_t targetNumberOfFrames;
+static uint32_t numberOfFrames;
+static uint64_t timestamp;
+static uint64_t previousMicroseconds;
+static char payload[STREAM_MAX_BATCH_SIZE * MAX_LINE_LENGTH];
+static size_t payloadIndex;
+static bool compressionEnabled;
+static Compression compression;
+static uint32_t framesSinceKeyframe = KEYFRAME_INTERVAL;
+static uint32_t decimation = 1;
+static uint32_t decimationCounter;
+static uint64_t increaseTicks;
+static uint64_t decreaseTicks;
+
+//------------------------------------------------------------------------------
+// Functions
+
+/**
+ * @brief Writes a frame to the stream.
+ * @param data Data.
+ */
+void StreamWrite(const AdcData * const data) {
+
+    // Discard frame if decimated
+    if (Decimate(data->timestamp)) {
+        return;
+    }
+
+    // Start message
+    const uint64_t microseconds = data->timestamp / TIMER_TICKS_PER_MICROSECOND;
+    if (numberOfFrames == 0) {
+        targetNumberOfFrames = batchSize == 0 ? AdaptiveBatchSize() : batchSize;
+        timestamp = data->timestamp;
+        previousMicroseconds = microseconds;
+        payloadIndex = 0;
+    }
+
+    // Write frame
+    const float values[] = {data->ch1, data->ch2, data->ch3, data->ch4, data->ch5, data->ch6, data->ch7, data->ch8};
+    if (compressionEnabled) {
+        WriteCompressed(microseconds, values);
+    } else {
+        WriteLine(microseconds, values);
+    }
+
+    // Discard message if truncated
+    if (payloadIndex > sizeof (payload)) {
+        numberOfFrames = 0;
+        framesSinceKeyframe = KEYFRAME_INTERVAL; // decoder state no longer matches
+        return;
+    }
+
+    // Send message
+    if (++numberOfFrames < targetNumberOfFrames) {
+        return;
+    }
+    numberOfFrames = 0;
+    if (SendSerialAccessoryData(timestamp, payload, payloadIndex) == false) {
+        framesSinceKeyframe = KEYFRAME_INTERVAL; // decoder state no longer matches
+    }
+}
+
+/**
+ * @brief Updates the decimation from the USB write buffer backlog and returns
+ * true if the frame should be discarded. The decimation is doubled while the
+ * backlog is high and halved once the backlog has remained low.
+ * @param ticks Frame timestamp.
+ * @return True if the frame should be discarded.
+ */
+static bool Decimate(const uint64_t ticks) {
+
+    // Update decimation
+    const size_t backlog = USB_CDC_WRITE_BUFFER_SIZE - UsbCdcAvailableWrite(UsbCdcQueueBulk);
+    if (backlog >= DECIMATION_DECREASE_BACKLOG) {
+        decreaseTicks = ticks + DECIMATION_DECREASE_PERIOD;
+    }
+    if ((backlog > DECIMATION_INCREASE_BACKLOG) && (decimation < MAX_DECIMATION) && (ticks >= increaseTicks)) {
+        SetDecimation(2 * decimation, ticks);
+    } else if ((decimation > 1) && (ticks >= decreaseTicks)) {
+        SetDecimation(decimation / 2, ticks);
+    }
+
+    // Discard all but every Nth frame
+    if (++decimationCounter < decimation) {
+        return true;
+    }
+    decimationCounter = 0;
+    return false;
+}
+
+/**
+ * @brief Sets the decimation and announces the change.
+ * @param decimation_ Decimation.
+ * @param ticks Ticks.
+ */
+static void SetDecimation(const uint32_t decimation_, const uint64_t ticks) {
+    decimation = decimation_;
+    decimationCounter = 0;
+    increaseTicks = ticks + DECIMATION_INCREASE_PERIOD;
+    decreaseTicks = ticks + DECIMATION_DECREASE_PERIOD;
+    SendNotification("Stream decimation %u", (unsigned int) decimation);
+}
+
+/**
+ * @brief Writes a frame as a line of comma-separated values.
+ * @param microseconds Microseconds.
+ * @param values Values.
+ */
+static void WriteLine(const uint64_t microseconds, const float * const values) {
+    if (batchSize != 1) {
+        AsciiDigits(payload, sizeof (payload), &payloadIndex, microseconds - previousMicroseconds, 1);
+        AsciiCharacter(payload, sizeof (payload), &payloadIndex, ',');
+        previousMicroseconds = microseconds;
+    }
+    for (int index = 0; index < COMPRESSION_NUMBER_OF_CHANNELS; index++) {
+        if (index > 0) {
+            AsciiCharacter(payload, sizeof (payload), &payloadIndex, ',');
+        }
+        AsciiFloatDecimals(payload, sizeof (payload), &payloadIndex, values[index], 6); // equivalent to "%f"
+    }
+    AsciiCharacter(payload, sizeof (payload), &payloadIndex, '\n');
+}
+
+/**
+ * @brief Writes a compressed frame. The first frame of a message is a keyframe
+ * if the keyframe interval has elapsed.
+ * @param microseconds Microseconds.
+ * @param values Values.
+ */
+static void WriteCompressed(const uint64_t microseconds, const float * const values) {
+    if (numberOfFrames == 0) {
+        const bool keyframe = framesSinceKeyframe >= KEYFRAME_INTERVAL;
+        if (keyframe) {
+            framesSinceKeyframe = 0;
+        }
+        CompressionEncodeHeader(&compression, payload, sizeof (payload), &payloadIndex, keyframe);
+    }
+    CompressionEncodeFrame(&compression, payload, sizeof (payload), &payloadIndex, (uint32_t) (microseconds - previousMicroseconds), values);
+    previousMicroseconds = microseconds;
+    framesSinceKeyframe++;
+}
+
+/**
+ * @brief Returns the adaptive batch size. The batch size increases with the
+ * USB write buffer backlog so that fewer, larger messages are sent while the
+ * host is slow to read.
+ * @return Adaptive batch size.
+ */
+static uint32_t AdaptiveBatchSize(void) {
+    const uint32_t backlog = USB_CDC_WRITE_BUFFER_SIZE - UsbCdcAvailableWrite(UsbCdcQueueBulk);
+    const uint32_t adaptiveBatchSize = 1 + (backlog / ADAPTIVE_BACKLOG_PER_FRAME);
+    return adaptiveBatchSize > STREAM_MAX_BATCH_SIZE ? STREAM_MAX_BATCH_SIZE : adaptiveBatchSize;
+}
+
+/**
+ * @brief Sets the number of frames per message. A value of 0 will select the
+ * batch size adaptively from the USB write buffer backlog.
+ * @param batchSize_ Batch size.
+ */
+void StreamSetBatchSize(const uint32_t batchSize_) {
+    batchSize = batchSize_ > STREAM_MAX_BATCH_SIZE ? STREAM_MAX_BATCH_SIZE : batchSize_;
+    numberOfFrames = 0;
+}
+
+/**
+ * @brief Returns the number of frames per message.
+ * @return Batch size.
+ */
+uint32_t StreamGetBatchSize(void) {
+    return batchSize;
+}
+
+/**
+ * @brief Enables or disables compression. The next message will start with a
+ * keyframe.
+ * @param enabled True to enable compression.
+ */
+void StreamSetCompression(const bool enabled) {
+    compressionEnabled = enabled;
+    framesSinceKeyframe = KEYFRAME_INTERVAL;
+    numberOfFrames = 0;
+}
+
+/**
+ * @brief Returns true if compression is enabled.
+ * @return True if compression is enabled.
+ */
+bool StreamGetCompression(void) {
+    return compressionEnabled;
+}
+
+//------------------------------------------------------------------------------
+// End of file
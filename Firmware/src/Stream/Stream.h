@@ -0,0 +1,37 @@
+/**
+ * @file Stream.h
+ * @author Seb Madgwick
+ * @brief Sensor data stream.
+ */
+
+#ifndef STREAM_H
+#define STREAM_H
+
+//------------------------------------------------------------------------------
+// Includes
+
+#include "Adc/Adc.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+//------------------------------------------------------------------------------
+// Definitions
+
+/**
+ * @brief Maximum number of frames per message.
+ */
+#define STREAM_MAX_BATCH_SIZE (8)
+
+//------------------------------------------------------------------------------
+// Function declarations
+
+void StreamWrite(const AdcData * const data);
+void StreamSetBatchSize(const uint32_t batchSize_);
+uint32_t StreamGetBatchSize(void);
+void StreamSetCompression(const bool enabled);
+bool StreamGetCompression(void);
+
+#endif
+
+//------------------------------------------------------------------------------
+// End of file
@@ -8,17 +8,22 @@
 // Includes
 
 #include "Adc/Adc.h"
+#include "Config.h"
 #include "Filter.h"
 #include "Leds/Leds.h"
 #include <math.h>
 #include "Send/Send.h"
+#include "Stream/Stream.h"
+#include <string.h>
 #include "Tap.h"
 #include "Timer/Timer.h"
 #include "TrueOnce.h"
+#include "Usb/UsbHid.h"
 
 //------------------------------------------------------------------------------
 // Function declarations
 
+static void Process(AdcData * const data);
 static inline __attribute__((always_inline)) void Detect(uint64_t * const holdoff, const float value, const char* const string, const LedsChannel channel);
 
 //------------------------------------------------------------------------------
@@ -56,64 +61,68 @@ void TapTasks(void) {
         FilterSetCutoff(&ch8Filter, sampleRate, cutoff);
     }
 
-    // Read ADC data
+    // Process all ADC data available
     AdcData data;
-    if (AdcGetData(&data) != AdcResultOk) {
-        return;
+    while (AdcGetData(&data) == AdcResultOk) {
+        Process(&data);
     }
+}
+
+/**
+ * @brief Processes ADC data.
+ * @param data ADC data.
+ */
+static void Process(AdcData * const data) {
 
     // Filter ADC data
-    data.ch1 = FilterUpdate(&ch1Filter, data.ch1);
-    data.ch2 = FilterUpdate(&ch2Filter, data.ch2);
-    data.ch3 = FilterUpdate(&ch3Filter, data.ch3);
-    data.ch4 = FilterUpdate(&ch4Filter, data.ch4);
-    data.ch5 = FilterUpdate(&ch5Filter, data.ch5);
-    data.ch6 = FilterUpdate(&ch6Filter, data.ch6);
-    data.ch7 = FilterUpdate(&ch7Filter, data.ch7);
-    data.ch8 = FilterUpdate(&ch8Filter, data.ch8);
+    data->ch1 = FilterUpdate(&ch1Filter, data->ch1);
+    data->ch2 = FilterUpdate(&ch2Filter, data->ch2);
+    data->ch3 = FilterUpdate(&ch3Filter, data->ch3);
+    data->ch4 = FilterUpdate(&ch4Filter, data->ch4);
+    data->ch5 = FilterUpdate(&ch5Filter, data->ch5);
+    data->ch6 = FilterUpdate(&ch6Filter, data->ch6);
+    data->ch7 = FilterUpdate(&ch7Filter, data->ch7);
+    data->ch8 = FilterUpdate(&ch8Filter, data->ch8);
 
     // Wait for filter outputs to settle
     if (TimerGetTicks64() < TIMER_TICKS_PER_SECOND) {
         return;
     }
 
-    // Send ADC data as serial accessory message
-    SendSerialAccessory(data.timestamp, "%f,%f,%f,%f,%f,%f,%f,%f\n",
-            data.ch1,
-            data.ch2,
-            data.ch3,
-            data.ch4,
-            data.ch5,
-            data.ch6,
-            data.ch7,
-            data.ch8);
+    // Send ADC data
+    StreamWrite(data);
 
     // Detect taps
     static uint64_t holdoff;
     if (TimerGetTicks64() < holdoff) {
         return;
     }
-    Detect(&holdoff, data.ch1, "CH1", LedsChannelCh1);
-    Detect(&holdoff, data.ch2, "CH2", LedsChannelCh2);
-    Detect(&holdoff, data.ch3, "CH3", LedsChannelCh3);
-    Detect(&holdoff, data.ch4, "CH4", LedsChannelCh4);
-    Detect(&holdoff, data.ch5, "CH5", LedsChannelCh5);
-    Detect(&holdoff, data.ch6, "CH6", LedsChannelCh6);
-    Detect(&holdoff, data.ch7, "CH7", LedsChannelCh7);
-    Detect(&holdoff, data.ch8, "CH8", LedsChannelCh8);
+    Detect(&holdoff, data->ch1, "CH1", LedsChannelCh1);
+    Detect(&holdoff, data->ch2, "CH2", LedsChannelCh2);
+    Detect(&holdoff, data->ch3, "CH3", LedsChannelCh3);
+    Detect(&holdoff, data->ch4, "CH4", LedsChannelCh4);
+    Detect(&holdoff, data->ch5, "CH5", LedsChannelCh5);
+    Detect(&holdoff, data->ch6, "CH6", LedsChannelCh6);
+    Detect(&holdoff, data->ch7, "CH7", LedsChannelCh7);
+    Detect(&holdoff, data->ch8, "CH8", LedsChannelCh8);
 }
 
 /**
- * @brief Detect tap.
+ * @brief Detect tap. Each tap is sent as a USB HID report containing the
+ * channel bit mask followed by the value as a little-endian float.
  * @param holdoff Holdoff.
  * @param value Value.
  * @param string String.
+ * @param channel Channel.
  */
 static inline __attribute__((always_inline)) void Detect(uint64_t * const holdoff, const float value, const char* const string, const LedsChannel channel) {
     if (fabs(value) < 0.1f) {
         return;
     }
     *holdoff = TimerGetTicks64() + (250 * TIMER_TICKS_PER_MILLISECOND);
+    uint8_t report[USB_HID_REPORT_SIZE] = {(uint8_t) channel};
+    memcpy(&report[4], &value, sizeof (value));
+    UsbHidWrite(report);
     SendNotification(string);
     LedsBlink(channel, ledsColourCyan);
 }
@@ -0,0 +1,160 @@
+/**
+ * @file Throughput.c
+ * @author Seb Madgwick
+ * @brief USB throughput self-test. Serial accessory messages containing a
+ * sequence-numbered pattern are sent at the requested rate through the same
+ * path as the sensor stream. A notification reporting the USB write transfer
+ * size is sent when the test is started so that results may be recorded for
+ * each build. A notification reporting the achieved rate, messages lost on the
+ * device, and USB write statistics is sent each second.
+ * The sequence may be validated on the host by throughput_test.py to determine
+ * if messages are lost after leaving the device.
+ *
+ * Payload:
+ * Bytes 0-3  "TPUT"
+ * Bytes 4-7  Sequence number, little-endian, incremented for each message
+ * Bytes 8... Byte n is (sequence number + n) modulo 256
+ */
+
+//------------------------------------------------------------------------------
+// Includes
+
+#include "Events/Events.h"
+#include "Send/Send.h"
+#include <string.h>
+#include "Throughput.h"
+#include "Timer/Timer.h"
+#include "Usb/UsbCdc.h"
+
+//------------------------------------------------------------------------------
+// Definitions
+
+/**
+ * @brief Payload size.
+ */
+#define PAYLOAD_SIZE (256)
+
+/**
+ * @brief Maximum number of messages sent per call to ThroughputTasks.
+ */
+#define MAX_MESSAGES_PER_TASK (8)
+
+//------------------------------------------------------------------------------
+// Function declarations
+
+static void Report(const uint64_t ticks);
+
+//------------------------------------------------------------------------------
+// Variables
+
+static uint32_t rate;
+static uint64_t startTicks;
+static uint64_t numberOfBytes;
+static uint32_t sequence;
+static uint64_t reportTicks;
+static uint32_t reportNumberOfBytes;
+static uint32_t reportNumberOfMessages;
+static uint32_t reportNumberOfLost;
+
+//------------------------------------------------------------------------------
+// Functions
+
+/**
+ * @brief Module tasks. This function should be called repeatedly within the
+ * main program loop.
+ */
+void ThroughputTasks(void) {
+
+    // Do nothing if not enabled
+    if (rate == 0) {
+        return;
+    }
+
+    // Send messages due
+    const uint64_t ticks = TimerGetTicks64();
+    const uint64_t numberOfBytesDue = ((ticks - startTicks) * rate) / TIMER_TICKS_PER_SECOND;
+    for (int index = 0; (index < MAX_MESSAGES_PER_TASK) && ((numberOfBytes + PAYLOAD_SIZE) <= numberOfBytesDue); index++) {
+        uint8_t payload[PAYLOAD_SIZE];
+        memcpy(payload, "TPUT", 4);
+        memcpy(&payload[4], &sequence, sizeof (sequence));
+        for (int payloadIndex = 8; payloadIndex < PAYLOAD_SIZE; payloadIndex++) {
+            payload[payloadIndex] = (uint8_t) (sequence + payloadIndex);
+        }
+        if (SendSerialAccessoryData(ticks, payload, sizeof (payload))) {
+            reportNumberOfBytes += PAYLOAD_SIZE;
+            reportNumberOfMessages++;
+        } else {
+            reportNumberOfLost++;
+        }
+        numberOfBytes += PAYLOAD_SIZE;
+        sequence++;
+    }
+
+    // Report
+    if ((ticks - reportTicks) >= TIMER_TICKS_PER_SECOND) {
+        Report(ticks);
+    }
+
+    // Keep main program loop polling while enabled
+    EventsSet(EventsThroughput);
+}
+
+/**
+ * @brief Sends report notification.
+ * @param ticks Ticks.
+ */
+static void Report(const uint64_t ticks) {
+    UsbCdcWriteStatistics writeStatistics;
+    UsbCdcGetWriteStatistics(&writeStatistics);
+    const uint64_t milliseconds = (ticks - reportTicks) / TIMER_TICKS_PER_MILLISECOND;
+    const uint32_t meanGap = writeStatistics.numberOfGaps == 0 ? 0 : (uint32_t) (writeStatistics.totalGapTicks / writeStatistics.numberOfGaps / TIMER_TICKS_PER_MICROSECOND);
+    SendNotification("Throughput %u bytes/s, %u messages, %u lost, %u transfers, %u errors, %u gaps, mean %u us, max %u us",
+            (unsigned int) (milliseconds == 0 ? 0 : (((uint64_t) reportNumberOfBytes * 1000) / milliseconds)),
+            (unsigned int) reportNumberOfMessages,
+            (unsigned int) reportNumberOfLost,
+            (unsigned int) writeStatistics.numberOfTransfers,
+            (unsigned int) writeStatistics.numberOfErrors,
+            (unsigned int) writeStatistics.numberOfGaps,
+            (unsigned int) meanGap,
+            (unsigned int) (writeStatistics.maxGapTicks / TIMER_TICKS_PER_MICROSECOND));
+    reportTicks = ticks;
+    reportNumberOfBytes = 0;
+    reportNumberOfMessages = 0;
+    reportNumberOfLost = 0;
+}
+
+/**
+ * @brief Sets the rate. The sequence number is reset each time the test is
+ * started. A value of 0 will stop the test.
+ * @param bytesPerSecond Rate in payload bytes per second.
+ */
+void ThroughputSetRate(const uint32_t bytesPerSecond) {
+    const uint64_t ticks = TimerGetTicks64();
+    if ((rate != 0) && (bytesPerSecond == 0)) {
+        Report(ticks);
+    }
+    if ((rate == 0) && (bytesPerSecond != 0)) {
+        UsbCdcWriteStatistics writeStatistics;
+        UsbCdcGetWriteStatistics(&writeStatistics); // reset statistics
+        sequence = 0;
+        reportTicks = ticks;
+        reportNumberOfBytes = 0;
+        reportNumberOfMessages = 0;
+        reportNumberOfLost = 0;
+        SendNotification("Throughput transfer size %u bytes, %u transfers", (unsigned int) USB_CDC_WRITE_TRANSFER_SIZE, (unsigned int) USB_CDC_WRITE_TRANSFERS);
+    }
+    rate = bytesPerSecond;
+    startTicks = ticks;
+    numberOfBytes = 0;
+}
+
+/**
+ * @brief Returns the rate.
+ * @return Rate in payload bytes per second.
+ */
+uint32_t ThroughputGetRate(void) {
+    return rate;
+}
+
+//------------------------------------------------------------------------------
+// End of file
@@ -0,0 +1,25 @@
+/**
+ * @file Throughput.h
+ * @author Seb Madgwick
+ * @brief USB throughput self-test.
+ */
+
+#ifndef THROUGHPUT_H
+#define THROUGHPUT_H
+
+//------------------------------------------------------------------------------
+// Includes
+
+#include <stdint.h>
+
+//------------------------------------------------------------------------------
+// Function declarations
+
+void ThroughputTasks(void);
+void ThroughputSetRate(const uint32_t bytesPerSecond);
+uint32_t ThroughputGetRate(void);
+
+#endif
+
+//------------------------------------------------------------------------------
+// End of file
@@ -0,0 +1,234 @@
+import argparse
+import csv
+import os
+import re
+import struct
+import sys
+import termios
+import time
+
+BYTE_STUFFING_END = 0x0A
+BYTE_STUFFING_ESC = 0xDB
+BYTE_STUFFING_ESC_END = 0xDC
+BYTE_STUFFING_ESC_ESC = 0xDD
+
+
+def open_port(path):
+    fd = os.open(path, os.O_RDWR | os.O_NOCTTY | os.O_NONBLOCK)
+
+    attributes = termios.tcgetattr(fd)
+    attributes[0] = 0  # iflag
+    attributes[1] = 0  # oflag
+    attributes[2] = termios.CS8 | termios.CREAD | termios.CLOCAL  # cflag
+    attributes[3] = 0  # lflag
+    termios.tcsetattr(fd, termios.TCSANOW, attributes)
+    termios.tcflush(fd, termios.TCIOFLUSH)
+
+    return fd
+
+
+def read_for(fds, seconds, messages):
+    buffers = {fd: bytearray() for fd in fds}
+    end = time.monotonic() + seconds
+
+    while time.monotonic() < end:
+        idle = True
+
+        for fd, buffer in buffers.items():
+            try:
+                data = os.read(fd, 65536)
+            except BlockingIOError:
+                continue
+
+            idle = False
+            buffer += data
+
+            while True:
+                index = buffer.find(b"\n")
+
+                if index < 0:
+                    break
+
+                messages.append(bytes(buffer[:index]))
+                del buffer[: index + 1]
+
+        if idle:
+            time.sleep(0.001)
+
+
+def unstuff(message):
+    result = bytearray()
+    index = 0
+
+    while index < len(message):
+        byte = message[index]
+
+        if byte == BYTE_STUFFING_ESC:
+            index += 1
+
+            if index >= len(message) or message[index] not in (BYTE_STUFFING_ESC_END, BYTE_STUFFING_ESC_ESC):
+                return None
+
+            byte = BYTE_STUFFING_END if message[index] == BYTE_STUFFING_ESC_END else BYTE_STUFFING_ESC
+
+        result.append(byte)
+        index += 1
+
+    return bytes(result)
+
+
+def run(port, stream_port, rate, duration):
+    fd = open_port(port)
+    stream_fd = open_port(stream_port)
+
+    messages = []
+
+    os.write(fd, f'{{"throughput":{rate}}}\n'.encode())
+    start = time.monotonic()
+    read_for((fd, stream_fd), duration, messages)
+    os.write(fd, b'{"throughput":0}\n')
+    stop = time.monotonic()
+    read_for((fd, stream_fd), 1.5, messages)
+
+    os.close(fd)
+    os.close(stream_fd)
+
+    expected_sequence = 0
+    number_of_messages = 0
+    number_of_bytes = 0
+    number_of_lost = 0
+    number_of_corrupt = 0
+    number_of_errors = 0
+    transfer_size = None
+    number_of_transfers = None
+
+    for message in messages:
+        message = message.rstrip(b"\r")
+
+        if len(message) == 0:
+            continue
+
+        first_byte = message[0]
+
+        if first_byte == 0x80 + ord("S"):
+            message = unstuff(message[1:])
+
+            if message is None or len(message) < 8:
+                number_of_corrupt += 1
+                continue
+
+            payload = message[8:]
+
+            if not payload.startswith(b"TPUT"):
+                continue  # sensor stream
+
+            if len(payload) < 8:
+                number_of_corrupt += 1
+                continue
+
+            sequence = struct.unpack("<I", payload[4:8])[0]
+
+            if any(byte != (sequence + index) & 0xFF for index, byte in enumerate(payload[8:], start=8)):
+                number_of_corrupt += 1
+
+            if sequence < expected_sequence:
+                print(f"Sequence restarted at {sequence}")
+            elif sequence > expected_sequence:
+                number_of_lost += sequence - expected_sequence
+
+            expected_sequence = sequence + 1
+            number_of_messages += 1
+            number_of_bytes += len(payload)
+
+        elif first_byte == 0x80 + ord("N"):
+            message = unstuff(message[1:])
+
+            if message is not None and len(message) >= 8:
+                notification = message[8:].decode(errors="replace")
+                print("Device: " + notification)
+
+                match = re.match(r"Throughput transfer size (\d+) bytes, (\d+) transfers", notification)
+
+                if match:
+                    transfer_size = int(match.group(1))
+                    number_of_transfers = int(match.group(2))
+
+        elif first_byte == 0x80 + ord("F"):
+            message = unstuff(message[1:])
+            number_of_errors += 1
+
+            if message is not None and len(message) >= 8:
+                print("Device error: " + message[8:].decode(errors="replace"))
+
+        elif first_byte == ord("F"):
+            number_of_errors += 1
+            print("Device error: " + message.decode(errors="replace"))
+
+        elif first_byte in (ord("{"), ord("N"), ord("E")):
+            print("Device: " + message.decode(errors="replace"))
+
+    received_rate = number_of_bytes / (stop - start)
+
+    print(f"Received {number_of_messages} messages, {received_rate:.0f} bytes/s")
+    print(f"Lost {number_of_lost} messages (sequence gaps, includes messages lost on the device)")
+    print(f"Corrupt {number_of_corrupt} messages")
+    print(f"Errors {number_of_errors} messages")
+
+    return {
+        "transfer_size": transfer_size,
+        "transfers": number_of_transfers,
+        "rate": rate,
+        "received_rate": round(received_rate),
+        "messages": number_of_messages,
+        "lost": number_of_lost,
+        "corrupt": number_of_corrupt,
+        "errors": number_of_errors,
+    }
+
+
+def sweep(arguments):
+    results = []
+
+    for rate in arguments.sweep:
+        print(f"Rate {rate} bytes/s")
+        results.append(run(arguments.port, arguments.stream_port, rate, arguments.duration))
+
+    new_file = not os.path.exists(arguments.results)
+
+    with open(arguments.results, "a", newline="") as file:
+        writer = csv.DictWriter(file, fieldnames=results[0].keys())
+
+        if new_file:
+            writer.writeheader()
+
+        writer.writerows(results)
+
+    print(f"Appended {len(results)} results to {arguments.results}")
+
+    for result in results:
+        print(f"Transfer size {result['transfer_size']} bytes, {result['transfers']} transfers, rate {result['rate']} bytes/s, received {result['received_rate']} bytes/s, lost {result['lost']}")
+
+    return all(result["corrupt"] == 0 and result["errors"] == 0 for result in results)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Validates the USB throughput self-test sequence.")
+    parser.add_argument("--port", default="/dev/ttyACM0", help="command port")
+    parser.add_argument("--stream-port", default="/dev/ttyACM1", help="stream port")
+    parser.add_argument("--rate", type=int, default=1000000, help="bytes per second")
+    parser.add_argument("--duration", type=float, default=10.0, help="seconds")
+    parser.add_argument("--sweep", type=int, nargs="+", metavar="RATE", help="run each rate and append the results for the transfer size reported by the device")
+    parser.add_argument("--results", default="throughput_results.csv", help="sweep results file")
+    arguments = parser.parse_args()
+
+    if arguments.sweep:
+        passed = sweep(arguments)
+    else:
+        result = run(arguments.port, arguments.stream_port, arguments.rate, arguments.duration)
+        passed = result["corrupt"] == 0 and result["errors"] == 0
+
+    sys.exit(0 if passed else 1)
+
+
+if __name__ == "__main__":
+    main()
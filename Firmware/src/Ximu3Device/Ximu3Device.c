@@ -7,12 +7,34 @@
 //------------------------------------------------------------------------------
 // Includes
 
+#include "Adc/Adc.h"
+#include "ClockSync/ClockSync.h"
 #include "Leds/Leds.h"
+#include <math.h>
 #include "Send/Send.h"
+#include <stdio.h>
+#include "Stream/Stream.h"
+#include <string.h>
+#include "Throughput/Throughput.h"
 #include "Timer/Timer.h"
+#include "Uart/Uart1.h"
+#include "Uart/Uart2.h"
 #include "Usb/UsbCdc.h"
 #include "x-IMU3-Device/Ximu3.h"
 
+//------------------------------------------------------------------------------
+// Definitions
+
+/**
+ * @brief Binary command ID.
+ */
+typedef enum {
+    BinaryCommandIdPing,
+    BinaryCommandIdBlink,
+    BinaryCommandIdStrobe,
+    BinaryCommandIdThroughput,
+} BinaryCommandId;
+
 //------------------------------------------------------------------------------
 // Function declarations
 
@@ -22,6 +44,17 @@ static void Ping(const char* * const value, Ximu3CommandResponse * const respons
 static void Blink(const char* * const value, Ximu3CommandResponse * const response, void* const context);
 static void Strobe(const char* * const value, Ximu3CommandResponse * const response, void* const context);
 static void Note(const char* * const value, Ximu3CommandResponse * const response, void* const context);
+static void Batch(const char* * const value, Ximu3CommandResponse * const response, void* const context);
+static void Compression(const char* * const value, Ximu3CommandResponse * const response, void* const context);
+static void Throughput(const char* * const value, Ximu3CommandResponse * const response, void* const context);
+static void ClockSync(const char* * const value, Ximu3CommandResponse * const response, void* const context);
+static void Statistics(const char* * const value, Ximu3CommandResponse * const response, void* const context);
+static Ximu3Result NumberToUint32(const float number, Ximu3CommandResponse * const response, uint32_t * const integer);
+static void SendStatistics(const char* const name, const FifoStatistics * const statistics);
+static Ximu3Result BinaryPing(const void* const payload, const size_t numberOfBytes, Ximu3CommandBinaryResponse * const response, void* const context);
+static Ximu3Result BinaryBlink(const void* const payload, const size_t numberOfBytes, Ximu3CommandBinaryResponse * const response, void* const context);
+static Ximu3Result BinaryStrobe(const void* const payload, const size_t numberOfBytes, Ximu3CommandBinaryResponse * const response, void* const context);
+static Ximu3Result BinaryThroughput(const void* const payload, const size_t numberOfBytes, Ximu3CommandBinaryResponse * const response, void* const context);
 static void Error(const char* const error, void* const context);
 
 //------------------------------------------------------------------------------
@@ -31,16 +64,30 @@ static Ximu3CommandInterface interfaces[] = {
     { .name = "USB", .read = UsbRead, .write = UsbWrite},
 };
 static const Ximu3CommandMap commands[] = {
-    {"ping", Ping},
-    {"blink", Blink},
-    {"strobe", Strobe},
-    {"note", Note},
+    [Ximu3CommandIndexPing] = {"ping", Ximu3CommandTypeNull, Ping},
+    [Ximu3CommandIndexBlink] = {"blink", Ximu3CommandTypeNull, Blink},
+    [Ximu3CommandIndexStrobe] = {"strobe", Ximu3CommandTypeNull, Strobe},
+    [Ximu3CommandIndexNote] = {"note", Ximu3CommandTypeString, Note},
+    [Ximu3CommandIndexBatch] = {"batch", Ximu3CommandTypeNumber, Batch},
+    [Ximu3CommandIndexCompression] = {"compression", Ximu3CommandTypeBoolean, Compression},
+    [Ximu3CommandIndexThroughput] = {"throughput", Ximu3CommandTypeNumber, Throughput},
+    [Ximu3CommandIndexClockSync] = {"clockSync", Ximu3CommandTypeNumber, ClockSync},
+    [Ximu3CommandIndexStatistics] = {"statistics", Ximu3CommandTypeNull, Statistics},
+};
+_Static_assert((sizeof (commands) / sizeof (commands[0])) == XIMU3_NUMBER_OF_COMMANDS, "Command map must contain every command of Ximu3Definitions.h.");
+static const Ximu3CommandBinaryMap binaryCommands[] = {
+    [BinaryCommandIdPing] = {Ximu3CommandBinaryTypeNone, BinaryPing},
+    [BinaryCommandIdBlink] = {Ximu3CommandBinaryTypeUint32, BinaryBlink},
+    [BinaryCommandIdStrobe] = {Ximu3CommandBinaryTypeNone, BinaryStrobe},
+    [BinaryCommandIdThroughput] = {Ximu3CommandBinaryTypeUint32, BinaryThroughput},
 };
 static Ximu3CommandBridge bridge = {
     .interfaces = interfaces,
     .numberOfInterfaces = sizeof (interfaces) / sizeof (Ximu3CommandInterface),
     .commands = commands,
     .numberOfCommands = sizeof (commands) / sizeof (Ximu3CommandMap),
+    .binaryCommands = binaryCommands,
+    .numberOfBinaryCommands = sizeof (binaryCommands) / sizeof (Ximu3CommandBinaryMap),
     .error = Error,
 };
 
@@ -132,6 +179,211 @@ static void Note(const char* * const value, Ximu3CommandResponse * const respons
     Ximu3CommandRespond(response);
 }
 
+/**
+ * @brief Batch command. Sets the number of frames per message. A value of 0
+ * will select the batch size adaptively.
+ * @param value Value.
+ * @param response Response.
+ * @param context Context.
+ */
+static void Batch(const char* * const value, Ximu3CommandResponse * const response, void* const context) {
+    float number;
+    if (Ximu3CommandParseNumber(value, response, &number) != 0) {
+        return;
+    }
+    uint32_t batchSize;
+    if (NumberToUint32(number, response, &batchSize) != 0) {
+        return;
+    }
+    StreamSetBatchSize(batchSize);
+    snprintf(response->value, sizeof (response->value), "%u", (unsigned int) StreamGetBatchSize());
+    Ximu3CommandRespond(response);
+}
+
+/**
+ * @brief Compression command. Enables or disables compression of the stream.
+ * @param value Value.
+ * @param response Response.
+ * @param context Context.
+ */
+static void Compression(const char* * const value, Ximu3CommandResponse * const response, void* const context) {
+    bool enabled;
+    if (Ximu3CommandParseBoolean(value, response, &enabled) != 0) {
+        return;
+    }
+    StreamSetCompression(enabled);
+    snprintf(response->value, sizeof (response->value), "%s", StreamGetCompression() ? "true" : "false");
+    Ximu3CommandRespond(response);
+}
+
+/**
+ * @brief Throughput command. Starts the USB throughput self-test at the rate
+ * in bytes per second. A value of 0 will stop the test.
+ * @param value Value.
+ * @param response Response.
+ * @param context Context.
+ */
+static void Throughput(const char* * const value, Ximu3CommandResponse * const response, void* const context) {
+    float number;
+    if (Ximu3CommandParseNumber(value, response, &number) != 0) {
+        return;
+    }
+    uint32_t rate;
+    if (NumberToUint32(number, response, &rate) != 0) {
+        return;
+    }
+    ThroughputSetRate(rate);
+    snprintf(response->value, sizeof (response->value), "%u", (unsigned int) ThroughputGetRate());
+    Ximu3CommandRespond(response);
+}
+
+/**
+ * @brief Clock sync command. Sets the interval in frames (1 ms) at which USB
+ * start of frame messages are sent. A value of 0 will disable the messages.
+ * @param value Value.
+ * @param response Response.
+ * @param context Context.
+ */
+static void ClockSync(const char* * const value, Ximu3CommandResponse * const response, void* const context) {
+    float number;
+    if (Ximu3CommandParseNumber(value, response, &number) != 0) {
+        return;
+    }
+    uint32_t interval;
+    if (NumberToUint32(number, response, &interval) != 0) {
+        return;
+    }
+    ClockSyncSetInterval(interval);
+    snprintf(response->value, sizeof (response->value), "%u", (unsigned int) ClockSyncGetInterval());
+    Ximu3CommandRespond(response);
+}
+
+/**
+ * @brief Statistics command. Sends a notification for each FIFO with the peak
+ * occupancy, number of overflows, and latency since the previous command.
+ * @param value Value.
+ * @param response Response.
+ * @param context Context.
+ */
+static void Statistics(const char* * const value, Ximu3CommandResponse * const response, void* const context) {
+    if (Ximu3CommandParseNull(value, response) != 0) {
+        return;
+    }
+    FifoStatistics statistics;
+    AdcGetFifoStatistics(&statistics);
+    SendStatistics("ADC", &statistics);
+    UsbCdcGetReadBufferStatistics(&statistics);
+    SendStatistics("USB read", &statistics);
+    UsbCdcGetWriteQueueStatistics(UsbCdcQueuePriority, &statistics);
+    SendStatistics("USB priority write", &statistics);
+    UsbCdcGetWriteQueueStatistics(UsbCdcQueueBulk, &statistics);
+    SendStatistics("USB bulk write", &statistics);
+    Uart1GetReadBufferStatistics(&statistics);
+    SendStatistics("UART1 read", &statistics);
+    Uart1GetWriteBufferStatistics(&statistics);
+    SendStatistics("UART1 write", &statistics);
+    Uart2GetReadBufferStatistics(&statistics);
+    SendStatistics("UART2 read", &statistics);
+    Uart2GetWriteBufferStatistics(&statistics);
+    SendStatistics("UART2 write", &statistics);
+    Ximu3CommandRespond(response);
+}
+
+/**
+ * @brief Converts a number to an unsigned integer. The number is truncated and
+ * clamped to the range of uint32_t. A NaN is rejected with an error response.
+ * @param number Number.
+ * @param response Response.
+ * @param integer Integer.
+ * @return Result.
+ */
+static Ximu3Result NumberToUint32(const float number, Ximu3CommandResponse * const response, uint32_t * const integer) {
+    if (isnan(number)) {
+        Ximu3CommandRespondError(response, "Invalid number.");
+        return Ximu3ResultError;
+    }
+    if (number <= 0.0f) {
+        *integer = 0;
+    } else if (number >= 4294967296.0f) { // UINT32_MAX is not representable as a float
+        *integer = UINT32_MAX;
+    } else {
+        *integer = (uint32_t) number;
+    }
+    return Ximu3ResultOk;
+}
+
+/**
+ * @brief Sends FIFO statistics as a notification.
+ * @param name FIFO name.
+ * @param statistics Statistics.
+ */
+static void SendStatistics(const char* const name, const FifoStatistics * const statistics) {
+    if (statistics->numberOfLatencySamples == 0) {
+        SendNotification("%s FIFO peak %u, %u overflows", name, (unsigned int) statistics->maxOccupancy, (unsigned int) statistics->numberOfOverflows);
+        return;
+    }
+    const uint32_t meanLatency = (uint32_t) ((statistics->totalLatencyTicks / statistics->numberOfLatencySamples) / TIMER_TICKS_PER_MICROSECOND);
+    const uint32_t maxLatency = statistics->maxLatencyTicks / TIMER_TICKS_PER_MICROSECOND;
+    SendNotification("%s FIFO peak %u, %u overflows, latency mean %u us, max %u us", name, (unsigned int) statistics->maxOccupancy, (unsigned int) statistics->numberOfOverflows, (unsigned int) meanLatency, (unsigned int) maxLatency);
+}
+
+/**
+ * @brief Binary ping command. The response has no payload so that the round
+ * trip time may be measured.
+ * @param payload Payload.
+ * @param numberOfBytes Number of bytes.
+ * @param response Response.
+ * @param context Context.
+ * @return Result.
+ */
+static Ximu3Result BinaryPing(const void* const payload, const size_t numberOfBytes, Ximu3CommandBinaryResponse * const response, void* const context) {
+    return Ximu3ResultOk;
+}
+
+/**
+ * @brief Binary blink command. The payload is the colour as 0x00RRGGBB.
+ * @param payload Payload.
+ * @param numberOfBytes Number of bytes.
+ * @param response Response.
+ * @param context Context.
+ * @return Result.
+ */
+static Ximu3Result BinaryBlink(const void* const payload, const size_t numberOfBytes, Ximu3CommandBinaryResponse * const response, void* const context) {
+    const LedsColour colour = {.rgb = *(const uint32_t*) payload};
+    LedsBlink(LedsChannelAll, colour);
+    return Ximu3ResultOk;
+}
+
+/**
+ * @brief Binary strobe command.
+ * @param payload Payload.
+ * @param numberOfBytes Number of bytes.
+ * @param response Response.
+ * @param context Context.
+ * @return Result.
+ */
+static Ximu3Result BinaryStrobe(const void* const payload, const size_t numberOfBytes, Ximu3CommandBinaryResponse * const response, void* const context) {
+    LedsStrobe();
+    return Ximu3ResultOk;
+}
+
+/**
+ * @brief Binary throughput command. The payload is the rate in bytes per
+ * second. The response payload is the rate that was set.
+ * @param payload Payload.
+ * @param numberOfBytes Number of bytes.
+ * @param response Response.
+ * @param context Context.
+ * @return Result.
+ */
+static Ximu3Result BinaryThroughput(const void* const payload, const size_t numberOfBytes, Ximu3CommandBinaryResponse * const response, void* const context) {
+    ThroughputSetRate(*(const uint32_t*) payload);
+    const uint32_t rate = ThroughputGetRate();
+    memcpy(response->payload, &rate, sizeof (rate));
+    response->numberOfBytes = sizeof (rate);
+    return Ximu3ResultOk;
+}
+
 /**
  * @brief Error handler.
  * @param error error.
@@ -0,0 +1,199 @@
+/**
+ * @file Ascii.h
+ * @author Seb Madgwick
+ * @brief ASCII data messages. A destination index greater than the destination
+ * size indicates that the message was truncated.
+ */
+
+#ifndef ASCII_H
+#define ASCII_H
+
+//------------------------------------------------------------------------------
+// Includes
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+//------------------------------------------------------------------------------
+// Definitions
+
+/**
+ * @brief Maximum number of decimal places supported by AsciiFloatDecimals.
+ */
+#define ASCII_MAX_DECIMALS 6
+
+//------------------------------------------------------------------------------
+// Inline functions
+
+/**
+ * @brief Writes a character.
+ * @param destination Destination.
+ * @param destinationSize Destination size.
+ * @param destinationIndex Destination index.
+ * @param character Character.
+ */
+static inline void AsciiCharacter(void* const destination, const size_t destinationSize, size_t * const destinationIndex, const char character) {
+    if (*destinationIndex >= destinationSize) {
+        *destinationIndex = destinationSize + 1; // indicate truncation
+        return;
+    }
+    ((char*) destination)[(*destinationIndex)++] = character;
+}
+
+/**
+ * @brief Writes an unsigned integer as decimal digits.
+ * @param destination Destination.
+ * @param destinationSize Destination size.
+ * @param destinationIndex Destination index.
+ * @param value Value.
+ * @param minimumDigits Minimum number of digits. Leading zeros are written as
+ * required.
+ */
+static inline void AsciiDigits(void* const destination, const size_t destinationSize, size_t * const destinationIndex, uint64_t value, const int minimumDigits) {
+    char digits[20];
+    int numberOfDigits = 0;
+    uint32_t value32;
+    while (value > UINT32_MAX) { // use 32-bit division once value is small enough
+        digits[numberOfDigits++] = '0' + (char) (value % 10);
+        value /= 10;
+    }
+    value32 = (uint32_t) value;
+    do {
+        digits[numberOfDigits++] = '0' + (char) (value32 % 10);
+        value32 /= 10;
+    } while (value32 != 0);
+    while (numberOfDigits < minimumDigits) {
+        digits[numberOfDigits++] = '0';
+    }
+    if ((*destinationIndex + numberOfDigits) > destinationSize) {
+        *destinationIndex = destinationSize + 1; // indicate truncation
+        return;
+    }
+    while (numberOfDigits > 0) {
+        ((char*) destination)[(*destinationIndex)++] = digits[--numberOfDigits];
+    }
+}
+
+/**
+ * @brief Writes the first byte.
+ * @param destination Destination.
+ * @param destinationSize Destination size.
+ * @param destinationIndex Destination index.
+ * @param character First character.
+ */
+static inline void AsciiFirstByte(void* const destination, const size_t destinationSize, size_t * const destinationIndex, const char character) {
+    AsciiCharacter(destination, destinationSize, destinationIndex, character);
+}
+
+/**
+ * @brief Writes a comma followed by the timestamp. Equivalent to
+ * ",%" PRIu64.
+ * @param destination Destination.
+ * @param destinationSize Destination size.
+ * @param destinationIndex Destination index.
+ * @param timestamp Timestamp.
+ */
+static inline void AsciiTimestamp(void* const destination, const size_t destinationSize, size_t * const destinationIndex, const uint64_t timestamp) {
+    AsciiCharacter(destination, destinationSize, destinationIndex, ',');
+    AsciiDigits(destination, destinationSize, destinationIndex, timestamp, 1);
+}
+
+/**
+ * @brief Writes a float with a fixed number of decimal places. The output is
+ * identical to "%.*f". The value is scaled exactly in double precision and
+ * rounded to nearest, ties to even, as printf does. Values too large to scale
+ * to a 64-bit integer, infinity, and NaN are written using snprintf.
+ * @param destination Destination.
+ * @param destinationSize Destination size.
+ * @param destinationIndex Destination index.
+ * @param value Value.
+ * @param decimals Number of decimal places. Must not exceed
+ * ASCII_MAX_DECIMALS.
+ */
+static inline void AsciiFloatDecimals(void* const destination, const size_t destinationSize, size_t * const destinationIndex, const float value, const int decimals) {
+    static const uint32_t powersOfTen[ASCII_MAX_DECIMALS + 1] = {1, 10, 100, 1000, 10000, 100000, 1000000};
+
+    // Write using snprintf if not common case
+    const double magnitude = fabs((double) value);
+    if ((isfinite(value) == 0) || (magnitude >= 9.0e12)) {
+        if (*destinationIndex >= destinationSize) {
+            *destinationIndex = destinationSize + 1; // indicate truncation
+            return;
+        }
+        const size_t available = destinationSize - *destinationIndex;
+        const int length = snprintf(&((char*) destination)[*destinationIndex], available, "%.*f", decimals, (double) value);
+        *destinationIndex = (length < 0) || ((size_t) length >= available) ? (destinationSize + 1) : (*destinationIndex + (size_t) length);
+        return;
+    }
+
+    // Scale and round to nearest, ties to even
+    const double scaled = magnitude * (double) powersOfTen[decimals]; // exact for float values and up to 6 decimal places
+    uint64_t integer = (uint64_t) scaled;
+    const double remainder = scaled - (double) integer;
+    if ((remainder > 0.5) || ((remainder == 0.5) && ((integer & 1) != 0))) {
+        integer++;
+    }
+
+    // Write sign, integer part, and fractional part
+    if (signbit(value) != 0) {
+        AsciiCharacter(destination, destinationSize, destinationIndex, '-');
+    }
+    AsciiDigits(destination, destinationSize, destinationIndex, integer / powersOfTen[decimals], 1);
+    if (decimals > 0) {
+        AsciiCharacter(destination, destinationSize, destinationIndex, '.');
+        AsciiDigits(destination, destinationSize, destinationIndex, integer % powersOfTen[decimals], decimals);
+    }
+}
+
+/**
+ * @brief Writes a comma followed by a float. Equivalent to ",%.4f".
+ * @param destination Destination.
+ * @param destinationSize Destination size.
+ * @param destinationIndex Destination index.
+ * @param value Value.
+ */
+static inline void AsciiFloat(void* const destination, const size_t destinationSize, size_t * const destinationIndex, const float value) {
+    AsciiCharacter(destination, destinationSize, destinationIndex, ',');
+    AsciiFloatDecimals(destination, destinationSize, destinationIndex, value, 4);
+}
+
+/**
+ * @brief Writes a comma followed by a string.
+ * @param destination Destination.
+ * @param destinationSize Destination size.
+ * @param destinationIndex Destination index.
+ * @param string String.
+ */
+static inline void AsciiString(void* const destination, const size_t destinationSize, size_t * const destinationIndex, const char* const string) {
+    AsciiCharacter(destination, destinationSize, destinationIndex, ',');
+    const size_t length = strlen(string);
+    if ((*destinationIndex + length) > destinationSize) {
+        *destinationIndex = destinationSize + 1; // indicate truncation
+        return;
+    }
+    memcpy(&((char*) destination)[*destinationIndex], string, length);
+    *destinationIndex += length;
+}
+
+/**
+ * @brief Writes the termination. The string is null-terminated if there is
+ * space available. The null character is not included in the destination
+ * index.
+ * @param destination Destination.
+ * @param destinationSize Destination size.
+ * @param destinationIndex Destination index.
+ */
+static inline void AsciiTermination(void* const destination, const size_t destinationSize, size_t * const destinationIndex) {
+    AsciiCharacter(destination, destinationSize, destinationIndex, '\n');
+    if (*destinationIndex < destinationSize) {
+        ((char*) destination)[*destinationIndex] = '\0';
+    }
+}
+
+#endif
+
+//------------------------------------------------------------------------------
+// End of file
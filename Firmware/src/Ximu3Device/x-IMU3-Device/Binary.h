@@ -1,7 +1,8 @@
 /**
  * @file Binary.h
  * @author Seb Madgwick
- * @brief Binary data messages.
+ * @brief Binary data messages. A destination index greater than the
+ * destination size indicates that the message was truncated.
  */
 
 #ifndef BINARY_H
@@ -10,9 +11,11 @@
 //------------------------------------------------------------------------------
 // Includes
 
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <string.h>
+#include "Ximu3Definitions.h"
 
 //------------------------------------------------------------------------------
 // Definitions
@@ -37,27 +40,58 @@
  */
 #define BYTE_STUFFING_ESC_ESC 0xDD
 
+/**
+ * @brief Multi-byte values are written as little-endian words.
+ */
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__)
+#error "Unsupported byte order."
+#endif
+
 //------------------------------------------------------------------------------
 // Inline functions
 
+/**
+ * @brief Returns true if any byte of the word is equal to the byte. Each byte
+ * of the pattern must be equal to the byte.
+ * @param word Word.
+ * @param pattern Byte repeated in each byte of the word.
+ * @return True if any byte of the word is equal to the byte.
+ */
+static inline __attribute__((always_inline)) bool BinaryWordContains(const uint32_t word, const uint32_t pattern) {
+    const uint32_t difference = word ^ pattern;
+    return ((difference - 0x01010101UL) & ~difference & 0x80808080UL) != 0;
+}
+
+/**
+ * @brief Returns true if any byte of the word requires byte stuffing.
+ * @param word Word.
+ * @return True if any byte of the word requires byte stuffing.
+ */
+static inline __attribute__((always_inline)) bool BinaryWordRequiresStuffing(const uint32_t word) {
+    return BinaryWordContains(word, 0x0A0A0A0AUL) || BinaryWordContains(word, 0xDBDBDBDBUL);
+}
+
 /**
  * @brief Writes a byte with byte stuffing.
  * @param destination Destination.
+ * @param destinationSize Destination size.
  * @param destinationIndex Destination index.
  * @param byte Byte.
  */
 static inline void BinaryWrite(void* const destination, const size_t destinationSize, size_t * const destinationIndex, const uint8_t byte) {
     if (*destinationIndex >= destinationSize) {
+        *destinationIndex = destinationSize + 1; // indicate truncation
         return;
     }
     switch (byte) {
         case BYTE_STUFFING_END:
-            ((uint8_t*) destination)[(*destinationIndex)++] = BYTE_STUFFING_ESC;
-            ((uint8_t*) destination)[(*destinationIndex)++] = BYTE_STUFFING_ESC_END;
-            break;
         case BYTE_STUFFING_ESC:
+            if ((*destinationIndex + 2) > destinationSize) {
+                *destinationIndex = destinationSize + 1; // indicate truncation
+                return;
+            }
             ((uint8_t*) destination)[(*destinationIndex)++] = BYTE_STUFFING_ESC;
-            ((uint8_t*) destination)[(*destinationIndex)++] = BYTE_STUFFING_ESC_ESC;
+            ((uint8_t*) destination)[(*destinationIndex)++] = byte == BYTE_STUFFING_END ? BYTE_STUFFING_ESC_END : BYTE_STUFFING_ESC_ESC;
             break;
         default:
             ((uint8_t*) destination)[(*destinationIndex)++] = byte;
@@ -65,9 +99,126 @@ static inline void BinaryWrite(void* const destination, const size_t destination
     }
 }
 
+/**
+ * @brief Writes bytes with byte stuffing. The data is scanned a word at a time
+ * so that runs of words that do not require byte stuffing are copied in bulk.
+ * The bytes of a word that requires byte stuffing are written individually.
+ * @param destination Destination.
+ * @param destinationSize Destination size.
+ * @param destinationIndex Destination index.
+ * @param data Data.
+ * @param numberOfBytes Number of bytes.
+ */
+static inline void BinaryBytes(void* const destination, const size_t destinationSize, size_t * const destinationIndex, const void* const data, const size_t numberOfBytes) {
+    const uint8_t * const bytes = (const uint8_t*) data;
+    size_t index = 0;
+    while (index < numberOfBytes) {
+
+        // Find end of run of words that do not require byte stuffing
+        size_t runEnd = index;
+        while ((numberOfBytes - runEnd) >= sizeof (uint32_t)) {
+            uint32_t word;
+            memcpy(&word, &bytes[runEnd], sizeof (word));
+            if (BinaryWordRequiresStuffing(word)) {
+                break;
+            }
+            runEnd += sizeof (uint32_t);
+        }
+
+        // Copy run
+        const size_t runLength = runEnd - index;
+        if (runLength > 0) {
+            if ((*destinationIndex + runLength) > destinationSize) {
+                if (*destinationIndex < destinationSize) {
+                    memcpy(&((uint8_t*) destination)[*destinationIndex], &bytes[index], destinationSize - *destinationIndex);
+                }
+                *destinationIndex = destinationSize + 1; // indicate truncation
+                return;
+            }
+            memcpy(&((uint8_t*) destination)[*destinationIndex], &bytes[index], runLength);
+            *destinationIndex += runLength;
+            index = runEnd;
+        }
+
+        // Write word that requires byte stuffing, or remaining bytes
+        const size_t wordEnd = (numberOfBytes - index) < sizeof (uint32_t) ? numberOfBytes : (index + sizeof (uint32_t));
+        while (index < wordEnd) {
+            BinaryWrite(destination, destinationSize, destinationIndex, bytes[index++]);
+        }
+    }
+}
+
+/**
+ * @brief Applies byte stuffing in place to the bytes already written to the
+ * destination from the start index. This allows data such as a formatted
+ * string to be written directly to the destination without a copy. The
+ * escape sequences are written from the end so that no byte is overwritten
+ * before it is read.
+ * @param destination Destination.
+ * @param destinationSize Destination size.
+ * @param destinationIndex Destination index.
+ * @param startIndex Index of the first byte to stuff.
+ */
+static inline void BinaryStuff(void* const destination, const size_t destinationSize, size_t * const destinationIndex, const size_t startIndex) {
+    if (*destinationIndex > destinationSize) {
+        return; // already truncated
+    }
+    uint8_t * const bytes = (uint8_t*) destination;
+
+    // Count bytes that require byte stuffing
+    size_t numberOfEscapes = 0;
+    for (size_t index = startIndex; index < *destinationIndex; index++) {
+        if ((bytes[index] == BYTE_STUFFING_END) || (bytes[index] == BYTE_STUFFING_ESC)) {
+            numberOfEscapes++;
+        }
+    }
+    if ((*destinationIndex + numberOfEscapes) > destinationSize) {
+        *destinationIndex = destinationSize + 1; // indicate truncation
+        return;
+    }
+
+    // Move bytes from end
+    size_t sourceIndex = *destinationIndex;
+    *destinationIndex += numberOfEscapes;
+    size_t index = *destinationIndex;
+    while (index > sourceIndex) {
+        const uint8_t byte = bytes[--sourceIndex];
+        switch (byte) {
+            case BYTE_STUFFING_END:
+            case BYTE_STUFFING_ESC:
+                bytes[--index] = byte == BYTE_STUFFING_END ? BYTE_STUFFING_ESC_END : BYTE_STUFFING_ESC_ESC;
+                bytes[--index] = BYTE_STUFFING_ESC;
+                break;
+            default:
+                bytes[--index] = byte;
+                break;
+        }
+    }
+}
+
+/**
+ * @brief Writes a 32-bit word.
+ * @param destination Destination.
+ * @param destinationSize Destination size.
+ * @param destinationIndex Destination index.
+ * @param word Word.
+ */
+static inline __attribute__((always_inline)) void BinaryWord(void* const destination, const size_t destinationSize, size_t * const destinationIndex, const uint32_t word) {
+    if ((BinaryWordRequiresStuffing(word) == false) && ((*destinationIndex + sizeof (word)) <= destinationSize)) {
+        memcpy(&((uint8_t*) destination)[*destinationIndex], &word, sizeof (word));
+        *destinationIndex += sizeof (word);
+        return;
+    }
+    BinaryWrite(destination, destinationSize, destinationIndex, (word >> 0) & 0xFF);
+    BinaryWrite(destination, destinationSize, destinationIndex, (word >> 8) & 0xFF);
+    BinaryWrite(destination, destinationSize, destinationIndex, (word >> 16) & 0xFF);
+    BinaryWrite(destination, destinationSize, destinationIndex, (word >> 24) & 0xFF);
+}
+
 /**
  * @brief Writes the first byte.
  * @param destination Destination.
+ * @param destinationSize Destination size.
  * @param destinationIndex Destination index.
  * @param character First character of equivalent ASCII data message.
  */
@@ -78,59 +229,114 @@ static inline void BinaryFirstByte(void* const destination, const size_t destina
 /**
  * @brief Writes the timestamp.
  * @param destination Destination.
+ * @param destinationSize Destination size.
  * @param destinationIndex Destination index.
  * @param timestamp Timestamp.
  */
 static inline void BinaryTimestamp(void* const destination, const size_t destinationSize, size_t * const destinationIndex, const uint64_t timestamp) {
-    BinaryWrite(destination, destinationSize, destinationIndex, (timestamp >> 0) & 0xFF);
-    BinaryWrite(destination, destinationSize, destinationIndex, (timestamp >> 8) & 0xFF);
-    BinaryWrite(destination, destinationSize, destinationIndex, (timestamp >> 16) & 0xFF);
-    BinaryWrite(destination, destinationSize, destinationIndex, (timestamp >> 24) & 0xFF);
-    BinaryWrite(destination, destinationSize, destinationIndex, (timestamp >> 32) & 0xFF);
-    BinaryWrite(destination, destinationSize, destinationIndex, (timestamp >> 40) & 0xFF);
-    BinaryWrite(destination, destinationSize, destinationIndex, (timestamp >> 48) & 0xFF);
-    BinaryWrite(destination, destinationSize, destinationIndex, (timestamp >> 56) & 0xFF);
+    BinaryWord(destination, destinationSize, destinationIndex, (uint32_t) timestamp);
+    BinaryWord(destination, destinationSize, destinationIndex, (uint32_t) (timestamp >> 32));
 }
 
 /**
  * @brief Writes a float.
  * @param destination Destination.
+ * @param destinationSize Destination size.
  * @param destinationIndex Destination index.
  * @param value Value.
  */
 static inline void BinaryFloat(void* const destination, const size_t destinationSize, size_t * const destinationIndex, const float value_) {
     uint32_t value;
     memcpy(&value, &value_, sizeof (value));
-    BinaryWrite(destination, destinationSize, destinationIndex, (value >> 0) & 0xFF);
-    BinaryWrite(destination, destinationSize, destinationIndex, (value >> 8) & 0xFF);
-    BinaryWrite(destination, destinationSize, destinationIndex, (value >> 16) & 0xFF);
-    BinaryWrite(destination, destinationSize, destinationIndex, (value >> 24) & 0xFF);
+    BinaryWord(destination, destinationSize, destinationIndex, value);
 }
 
 /**
  * @brief Writes a string.
  * @param destination Destination.
+ * @param destinationSize Destination size.
  * @param destinationIndex Destination index.
  * @param string String.
  */
 static inline void BinaryString(void* const destination, const size_t destinationSize, size_t * const destinationIndex, const char* string) {
-    while (*string != '\0') {
-        BinaryWrite(destination, destinationSize, destinationIndex, *string++);
-    }
+    BinaryBytes(destination, destinationSize, destinationIndex, string, strlen(string));
 }
 
 /**
  * @brief Writes the termination.
  * @param destination Destination.
+ * @param destinationSize Destination size.
  * @param destinationIndex Destination index.
  */
 static inline void BinaryTermination(void* const destination, const size_t destinationSize, size_t * const destinationIndex) {
     if (*destinationIndex >= destinationSize) {
+        *destinationIndex = destinationSize + 1; // indicate truncation
         return;
     }
     ((uint8_t*) destination)[(*destinationIndex)++] = BYTE_STUFFING_END;
 }
 
+/**
+ * @brief Reverses byte stuffing. The source must not include the termination.
+ * The source is scanned a word at a time so that runs of bytes that do not
+ * contain an escape byte are copied in bulk.
+ * @param destination Destination.
+ * @param destinationSize Destination size.
+ * @param destinationIndex Destination index.
+ * @param source Source.
+ * @param numberOfBytes Number of bytes.
+ * @return Result.
+ */
+static inline Ximu3Result BinaryDecode(void* const destination, const size_t destinationSize, size_t * const destinationIndex, const void* const source, const size_t numberOfBytes) {
+    const uint8_t * const bytes = (const uint8_t*) source;
+    size_t index = 0;
+    while (index < numberOfBytes) {
+
+        // Find end of run that does not contain an escape byte
+        size_t runEnd = index;
+        while ((numberOfBytes - runEnd) >= sizeof (uint32_t)) {
+            uint32_t word;
+            memcpy(&word, &bytes[runEnd], sizeof (word));
+            if (BinaryWordContains(word, 0xDBDBDBDBUL)) {
+                break;
+            }
+            runEnd += sizeof (uint32_t);
+        }
+        while ((runEnd < numberOfBytes) && (bytes[runEnd] != BYTE_STUFFING_ESC)) {
+            runEnd++;
+        }
+
+        // Copy run
+        const size_t runLength = runEnd - index;
+        if ((*destinationIndex + runLength) > destinationSize) {
+            return Ximu3ResultError;
+        }
+        memcpy(&((uint8_t*) destination)[*destinationIndex], &bytes[index], runLength);
+        *destinationIndex += runLength;
+        index = runEnd;
+
+        // Decode escape sequence
+        if (index >= numberOfBytes) {
+            break;
+        }
+        if (((index + 2) > numberOfBytes) || (*destinationIndex >= destinationSize)) {
+            return Ximu3ResultError;
+        }
+        switch (bytes[index + 1]) {
+            case BYTE_STUFFING_ESC_END:
+                ((uint8_t*) destination)[(*destinationIndex)++] = BYTE_STUFFING_END;
+                break;
+            case BYTE_STUFFING_ESC_ESC:
+                ((uint8_t*) destination)[(*destinationIndex)++] = BYTE_STUFFING_ESC;
+                break;
+            default:
+                return Ximu3ResultError;
+        }
+        index += 2;
+    }
+    return Ximu3ResultOk;
+}
+
 #endif
 
 //------------------------------------------------------------------------------
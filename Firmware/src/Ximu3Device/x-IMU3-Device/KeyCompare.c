@@ -1,7 +1,7 @@
 /**
  * @file KeyCompare.c
  * @author Seb Madgwick
- * @brief Compares two JSON keys.
+ * @brief Compares and normalises JSON keys.
  */
 
 //------------------------------------------------------------------------------
@@ -69,6 +69,28 @@ bool KeyComparePartial(const char* * const input, const char* target) {
     }
 }
 
+/**
+ * @brief Normalises the key so that it may be compared using strcmp. The
+ * normalised key is lower-case with non-alphanumeric characters removed. The
+ * normalised key will be truncated if the destination is too small.
+ * @param input Input key.
+ * @param destination Destination.
+ * @param destinationSize Destination size.
+ * @return Number of characters in the normalised key.
+ */
+size_t KeyNormalise(const char* input, char* const destination, const size_t destinationSize) {
+    size_t length = 0;
+    while (length < (destinationSize - 1)) {
+        SkipNonAlphanumeric(&input);
+        if (*input == '\0') {
+            break;
+        }
+        destination[length++] = ToLower(*input++);
+    }
+    destination[length] = '\0';
+    return length;
+}
+
 /**
  * @brief Advances pointer to first alphanumeric character.
  * @param string String.
@@ -1,7 +1,7 @@
 /**
  * @file KeyCompare.h
  * @author Seb Madgwick
- * @brief Compares two JSON keys.
+ * @brief Compares and normalises JSON keys.
  */
 
 #ifndef KEY_COMPARE_H
@@ -11,12 +11,14 @@
 // Includes
 
 #include <stdbool.h>
+#include <stddef.h>
 
 //------------------------------------------------------------------------------
 // Function declarations
 
 bool KeyCompare(const char* input, const char* target);
 bool KeyComparePartial(const char* * const input, const char* target);
+size_t KeyNormalise(const char* input, char* const destination, const size_t destinationSize);
 
 #endif
 
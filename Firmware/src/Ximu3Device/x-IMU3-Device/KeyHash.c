@@ -0,0 +1,47 @@
+// This file was generated by generate.py
+
+#include "KeyHash.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "Ximu3Definitions.h"
+
+#define SEED 0x811C9DC6u
+
+#define MASK 63u
+
+static const KeyHashEntry entries[MASK + 1] = {
+    [2] = {"note", KeyHashTypeCommand, Ximu3CommandIndexNote},
+    [12] = {"throughput", KeyHashTypeCommand, Ximu3CommandIndexThroughput},
+    [14] = {"calibrationdate", KeyHashTypeSetting, Ximu3SettingsIndexCalibrationDate},
+    [16] = {"compression", KeyHashTypeCommand, Ximu3CommandIndexCompression},
+    [17] = {"statistics", KeyHashTypeCommand, Ximu3CommandIndexStatistics},
+    [19] = {"clocksync", KeyHashTypeCommand, Ximu3CommandIndexClockSync},
+    [23] = {"serialnumber", KeyHashTypeSetting, Ximu3SettingsIndexSerialNumber},
+    [24] = {"binarymode", KeyHashTypeSetting, Ximu3SettingsIndexBinaryMode},
+    [27] = {"devicename", KeyHashTypeSetting, Ximu3SettingsIndexDeviceName},
+    [30] = {"ping", KeyHashTypeCommand, Ximu3CommandIndexPing},
+    [33] = {"offset", KeyHashTypeSetting, Ximu3SettingsIndexOffset},
+    [43] = {"messageratedivisor", KeyHashTypeSetting, Ximu3SettingsIndexMessageRateDivisor},
+    [47] = {"strobe", KeyHashTypeCommand, Ximu3CommandIndexStrobe},
+    [50] = {"batch", KeyHashTypeCommand, Ximu3CommandIndexBatch},
+    [57] = {"firmwareversion", KeyHashTypeSetting, Ximu3SettingsIndexFirmwareVersion},
+    [60] = {"blink", KeyHashTypeCommand, Ximu3CommandIndexBlink},
+    [61] = {"sensitivity", KeyHashTypeSetting, Ximu3SettingsIndexSensitivity},
+};
+
+static uint32_t Hash(const char* key) {
+    uint32_t hash = SEED;
+    while (*key != '\0') {
+        hash = (hash ^ (uint8_t) *key++) * 16777619u;
+    }
+    return hash;
+}
+
+const KeyHashEntry* KeyHashFind(const char* const key) {
+    const KeyHashEntry* const entry = &entries[Hash(key) & MASK];
+    if ((entry->key == NULL) || (strcmp(entry->key, key) != 0)) {
+        return NULL;
+    }
+    return entry;
+}
@@ -0,0 +1,19 @@
+// This file was generated by generate.py
+
+#ifndef KEY_HASH_H
+#define KEY_HASH_H
+
+typedef enum {
+    KeyHashTypeSetting,
+    KeyHashTypeCommand,
+} KeyHashType;
+
+typedef struct {
+    const char* const key;
+    const KeyHashType type;
+    const int index;
+} KeyHashEntry;
+
+const KeyHashEntry* KeyHashFind(const char* const key);
+
+#endif
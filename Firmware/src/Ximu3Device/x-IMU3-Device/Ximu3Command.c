@@ -7,8 +7,10 @@
 //------------------------------------------------------------------------------
 // Includes
 
+#include "Binary.h"
 #include "JSON/Json.h"
 #include "KeyCompare.h"
+#include "KeyHash.h"
 #include "Metadata.h"
 #include <stdarg.h>
 #include <stdbool.h>
@@ -25,13 +27,79 @@
  */
 //#define PRINT_MESSAGES
 
+/**
+ * @brief Number of bytes read from the interface at a time.
+ */
+#define READ_SIZE (64)
+
+/**
+ * @brief Appended to the aggregate response if the responses do not fit.
+ */
+#define AGGREGATE_OVERFLOW "\"error\":\"Response too long\","
+
+/**
+ * @brief Aggregate response. The responses of every key/value pair of a
+ * message are sent as a single object.
+ */
+typedef struct {
+    char* const destination;
+    size_t destinationSize;
+    size_t length;
+    bool overflow;
+} Aggregate;
+
+/**
+ * @brief Key/value pair type.
+ */
+typedef enum {
+    PairTypeCommand,
+    PairTypeSettingRead,
+    PairTypeSettingWrite,
+    PairTypeEnumerate,
+    PairTypeUnknown,
+} PairType;
+
+/**
+ * @brief Key/value pair. Recorded in the parser buffer between the key and the
+ * value once the value has ended so that the key is not looked up again when
+ * the pair is executed. The index is the command index, setting index, or
+ * enumerate index. The enumerate index is XIMU3_NUMBER_OF_SETTINGS if it is not
+ * a setting.
+ */
+typedef struct {
+    uint8_t type;
+    uint8_t index;
+} Pair;
+
+#if XIMU3_NUMBER_OF_SETTINGS > UINT8_MAX
+#error "Setting index does not fit in the key/value pair."
+#endif
+
 //------------------------------------------------------------------------------
 // Function declarations
 
 static void Receive(Ximu3CommandBridge * const bridge, Ximu3CommandInterface * const interface);
-static void ParseMessage(const Ximu3CommandBridge * const bridge, const Ximu3CommandInterface * const interface, uint8_t * const message, const size_t messageSize);
+static void ParseByte(const Ximu3CommandBridge * const bridge, const Ximu3CommandInterface * const interface, Ximu3CommandParser * const parser, const char byte);
+static void ParseKeyEnd(const Ximu3CommandBridge * const bridge, const Ximu3CommandInterface * const interface, Ximu3CommandParser * const parser);
+static void ParseValue(const Ximu3CommandBridge * const bridge, const Ximu3CommandInterface * const interface, Ximu3CommandParser * const parser, const char byte);
+static void ParseObjectEnd(const Ximu3CommandBridge * const bridge, const Ximu3CommandInterface * const interface, Ximu3CommandParser * const parser, const char byte);
+static void ParseArrayNext(const Ximu3CommandBridge * const bridge, const Ximu3CommandInterface * const interface, Ximu3CommandParser * const parser, const char byte);
+static bool ParsePair(const Ximu3CommandBridge * const bridge, const Ximu3CommandInterface * const interface, Ximu3CommandParser * const parser);
+static bool Record(Ximu3CommandParser * const parser, const char byte);
 static void ParseMux(const Ximu3CommandBridge * const bridge, const Ximu3CommandInterface * const interface, const uint8_t * const message, const size_t messageSize);
-static void ParseCommand(const Ximu3CommandBridge * const bridge, const Ximu3CommandInterface * const interface, uint8_t * const message, const size_t messageSize);
+static void ParseBinary(const Ximu3CommandBridge * const bridge, const Ximu3CommandInterface * const interface, const uint8_t * const message, const size_t messageSize);
+static Ximu3CommandBinaryStatus ExecuteBinary(const Ximu3CommandBridge * const bridge, const Ximu3CommandInterface * const interface, const uint8_t id, const void* const payload, const size_t numberOfBytes, Ximu3CommandBinaryResponse * const response);
+static bool IsBinaryPayloadValid(const Ximu3CommandBinaryType type, const size_t numberOfBytes);
+static void RespondBinary(const Ximu3CommandBridge * const bridge, const Ximu3CommandInterface * const interface, const uint8_t id, const Ximu3CommandBinaryStatus status, const Ximu3CommandBinaryResponse * const response);
+static void Dispatch(const Ximu3CommandBridge * const bridge, const Ximu3CommandInterface * const interface, Ximu3CommandParser * const parser);
+static void RespondAggregate(const Ximu3CommandBridge * const bridge, const Ximu3CommandInterface * const interface, Aggregate * const aggregate);
+static const char* Resolve(const Ximu3CommandBridge * const bridge, Ximu3CommandResponse * const response, const char* value, const bool validate, Pair * const pair);
+static void Append(Aggregate * const aggregate, const Ximu3CommandResponse * const response);
+static void Execute(const Ximu3CommandBridge * const bridge, Ximu3CommandResponse * const response, const Pair pair, const char* value, bool * const written);
+static void ExecuteSettingWrite(const Ximu3CommandBridge * const bridge, Ximu3CommandResponse * const response, const Ximu3SettingsIndex index, const char* value, bool * const written);
+static const Ximu3CommandMap* FindCommand(const Ximu3CommandBridge * const bridge, const KeyHashEntry * const entry, const char* const normalisedKey);
+static bool IsWhiteSpace(const char byte);
+static void Reject(const Ximu3CommandBridge * const bridge, const Ximu3CommandInterface * const interface, Ximu3CommandParser * const parser, const char byte, const char* const error);
 static void Error(const Ximu3CommandBridge * const bridge, const char* format, ...);
 
 //------------------------------------------------------------------------------
@@ -57,52 +125,32 @@ static void Receive(Ximu3CommandBridge * const bridge, Ximu3CommandInterface * c
     while (true) {
 
         // Read data
-        uint8_t data[XIMU3_OBJECT_SIZE];
+        char data[READ_SIZE];
         const size_t numberOfBytes = interface->read(data, sizeof (data), bridge->context);
         if (numberOfBytes == 0) {
             break;
         }
 
-        // Process each byte
+        // Parse each byte
         for (size_t index = 0; index < numberOfBytes; index++) {
-
-            // Add to buffer
-            interface->buffer[interface->index] = data[index];
-
-            // Parse if termination detected
-            if (interface->buffer[interface->index] == '\n') {
-                ParseMessage(bridge, interface, interface->buffer, interface->index + 1);
-                interface->index = 0;
-                continue;
-            }
-
-            // Increment index
-            if (++interface->index >= sizeof (interface->buffer)) {
-                Error(bridge, "%s receive error. Buffer overrun.", interface->name);
-                interface->index = 0;
-            }
+            ParseByte(bridge, interface, &interface->parser, data[index]);
         }
     }
 }
 
 /**
- * @brief Receive data as a single, complete message.
+ * @brief Receive data as a single, complete message. The message is parsed by
+ * the parser of the interface so the interface must not also be read by
+ * Ximu3CommandTasks.
  * @param bridge Bridge.
  * @param interface Interface.
  * @param data Data.
  * @param numberOfBytes Number of bytes.
  */
-void Ximu3CommandReceive(const Ximu3CommandBridge * const bridge, const Ximu3CommandInterface * const interface, const void* const data, const size_t numberOfBytes) {
-
-    // Copy data
-    uint8_t message[XIMU3_OBJECT_SIZE];
-    if (numberOfBytes > sizeof (message)) {
-        Error(bridge, "%s receive error. Buffer overrun.", interface->name);
-        return;
-    }
-    memcpy(message, data, numberOfBytes);
+void Ximu3CommandReceive(const Ximu3CommandBridge * const bridge, Ximu3CommandInterface * const interface, const void* const data, const size_t numberOfBytes) {
 
     // Validate termination
+    const char* const message = data;
     for (size_t index = 0; index < (numberOfBytes - 1); index++) {
         if (message[index] == '\n') {
             Error(bridge, "%s receive error. Unexpected termination.", interface->name);
@@ -115,22 +163,360 @@ void Ximu3CommandReceive(const Ximu3CommandBridge * const bridge, const Ximu3Com
     }
 
     // Parse
-    ParseMessage(bridge, interface, message, numberOfBytes);
+    interface->parser.state = Ximu3CommandParserStateObjectStart;
+    for (size_t index = 0; index < numberOfBytes; index++) {
+        ParseByte(bridge, interface, &interface->parser, message[index]);
+    }
 }
 
 /**
- * @brief Parse message.
+ * @brief Parses a byte. Each key is decoded in place and each value is
+ * terminated in place as they end so that the buffer holds a sequence of key
+ * and value strings that is not parsed again when executed. Each key/value
+ * pair is looked up, and validated if part of a batch, as it ends. A command is
+ * dispatched as soon as the object ends and the remainder of the line is
+ * discarded. Malformed messages are rejected at the first invalid byte and the
+ * remainder of the line is discarded. An object of more than one key/value
+ * pair, or an array of objects of one key/value pair, is a batch. Mux and
+ * binary messages are distinguished by their first byte and are buffered until
+ * the termination.
  * @param bridge Bridge.
  * @param interface Interface.
- * @param message Message.
- * @param messageSize Message size.
+ * @param parser Parser.
+ * @param byte Byte.
+ */
+static void ParseByte(const Ximu3CommandBridge * const bridge, const Ximu3CommandInterface * const interface, Ximu3CommandParser * const parser, const char byte) {
+    switch (parser->state) {
+        case Ximu3CommandParserStateObjectStart:
+            if (byte == '^') {
+                parser->buffer[0] = byte;
+                parser->index = 1;
+                parser->state = Ximu3CommandParserStateMux;
+                break;
+            }
+            if ((uint8_t) byte == XIMU3_COMMAND_BINARY_FIRST_BYTE) {
+                parser->buffer[0] = byte;
+                parser->index = 1;
+                parser->state = Ximu3CommandParserStateBinary;
+                break;
+            }
+            if (IsWhiteSpace(byte)) {
+                break;
+            }
+            parser->index = 0;
+            parser->numberOfPairs = 0;
+            parser->array = false;
+            parser->batch = false;
+            if (byte == '[') {
+                parser->array = true;
+                parser->batch = true;
+                parser->state = Ximu3CommandParserStateArrayObjectStart;
+                break;
+            }
+            if (byte != '{') {
+                Reject(bridge, interface, parser, byte, "Not a JSON object.");
+                break;
+            }
+            parser->state = Ximu3CommandParserStateKeyStart;
+            break;
+        case Ximu3CommandParserStateArrayObjectStart:
+            if (IsWhiteSpace(byte)) {
+                break;
+            }
+            if (byte != '{') {
+                Reject(bridge, interface, parser, byte, "Unable able to parse batch. Not a JSON object.");
+                break;
+            }
+            parser->state = Ximu3CommandParserStateKeyStart;
+            break;
+        case Ximu3CommandParserStateKeyStart:
+            if (IsWhiteSpace(byte)) {
+                break;
+            }
+            if (byte != '"') {
+                Reject(bridge, interface, parser, byte, "Unable able to parse key. Missing key.");
+                break;
+            }
+            parser->keyIndex = parser->index;
+            parser->escape = false;
+            if (Record(parser, byte) == false) {
+                Reject(bridge, interface, parser, byte, "Buffer overrun.");
+                break;
+            }
+            parser->state = Ximu3CommandParserStateKey;
+            break;
+        case Ximu3CommandParserStateKey:
+            if (byte == '\n') {
+                Reject(bridge, interface, parser, byte, "Unable able to parse key. Missing string end.");
+                break;
+            }
+            if ((parser->index - parser->keyIndex) >= (XIMU3_KEY_SIZE - 1)) {
+                Reject(bridge, interface, parser, byte, "Unable able to parse key. String too long.");
+                break;
+            }
+            if (Record(parser, byte) == false) {
+                Reject(bridge, interface, parser, byte, "Buffer overrun.");
+                break;
+            }
+            if (parser->escape) {
+                parser->escape = false;
+            } else if (byte == '\\') {
+                parser->escape = true;
+            } else if (byte == '"') {
+                ParseKeyEnd(bridge, interface, parser);
+            }
+            break;
+        case Ximu3CommandParserStateColon:
+            if (IsWhiteSpace(byte)) {
+                break;
+            }
+            if (byte != ':') {
+                Reject(bridge, interface, parser, byte, "Unable able to parse key. Missing colon.");
+                break;
+            }
+            if ((sizeof (parser->buffer) - parser->index) < sizeof (Pair)) {
+                Reject(bridge, interface, parser, byte, "Buffer overrun.");
+                break;
+            }
+            parser->index += sizeof (Pair); // recorded once the value ends
+            parser->valueIndex = parser->index;
+            parser->depth = 0;
+            parser->string = false;
+            parser->escape = false;
+            parser->state = Ximu3CommandParserStateValueStart;
+            break;
+        case Ximu3CommandParserStateValueStart:
+            if (IsWhiteSpace(byte)) {
+                break;
+            }
+            if ((byte == '}') || (byte == ']') || (byte == ',')) {
+                Reject(bridge, interface, parser, byte, "Unable able to parse value. Invalid syntax.");
+                break;
+            }
+            parser->state = Ximu3CommandParserStateValue;
+            ParseValue(bridge, interface, parser, byte);
+            break;
+        case Ximu3CommandParserStateValue:
+            ParseValue(bridge, interface, parser, byte);
+            break;
+        case Ximu3CommandParserStateObjectEnd:
+            if (IsWhiteSpace(byte)) {
+                break;
+            }
+            ParseObjectEnd(bridge, interface, parser, byte);
+            break;
+        case Ximu3CommandParserStateArrayNext:
+            if (IsWhiteSpace(byte)) {
+                break;
+            }
+            ParseArrayNext(bridge, interface, parser, byte);
+            break;
+        case Ximu3CommandParserStateMux:
+        case Ximu3CommandParserStateBinary:
+            if (parser->index >= sizeof (parser->buffer)) {
+                Reject(bridge, interface, parser, byte, "Buffer overrun.");
+                break;
+            }
+            parser->buffer[parser->index++] = byte;
+            if (byte == '\n') {
+                if (parser->state == Ximu3CommandParserStateMux) {
+                    ParseMux(bridge, interface, parser->buffer, parser->index);
+                } else {
+                    ParseBinary(bridge, interface, parser->buffer, parser->index);
+                }
+                parser->state = Ximu3CommandParserStateObjectStart;
+            }
+            break;
+        case Ximu3CommandParserStateDiscard:
+            if (byte == '\n') {
+                parser->state = Ximu3CommandParserStateObjectStart;
+            }
+            break;
+    }
+}
+
+/**
+ * @brief Parses the end of the key. The key is decoded in place so that it is
+ * not parsed again when the key/value pair is executed.
+ * @param bridge Bridge.
+ * @param interface Interface.
+ * @param parser Parser.
  */
-static void ParseMessage(const Ximu3CommandBridge * const bridge, const Ximu3CommandInterface * const interface, uint8_t * const message, const size_t messageSize) {
-    if (message[0] == '^') {
-        ParseMux(bridge, interface, message, messageSize);
+static void ParseKeyEnd(const Ximu3CommandBridge * const bridge, const Ximu3CommandInterface * const interface, Ximu3CommandParser * const parser) {
+    char* const key = (char*) &parser->buffer[parser->keyIndex];
+    const char* json = key;
+    size_t numberOfBytes;
+    const JsonResult result = JsonParseString(&json, key, XIMU3_KEY_SIZE, &numberOfBytes); // decoded key is never longer than the JSON string
+    if (result != JsonResultOk) {
+        Error(bridge, "%s receive error. Unable able to parse key. %s.", interface->name, JsonResultToString(result));
+        parser->state = Ximu3CommandParserStateDiscard;
+        return;
+    }
+    parser->index = parser->keyIndex + numberOfBytes; // include termination
+    parser->state = Ximu3CommandParserStateColon;
+}
+
+/**
+ * @brief Parses a byte of the value. Strings, objects, and arrays end with
+ * their closing character. Other values end with white space, a comma, or the
+ * object end.
+ * @param bridge Bridge.
+ * @param interface Interface.
+ * @param parser Parser.
+ * @param byte Byte.
+ */
+static void ParseValue(const Ximu3CommandBridge * const bridge, const Ximu3CommandInterface * const interface, Ximu3CommandParser * const parser, const char byte) {
+
+    // Reject if line ends before value
+    if (byte == '\n') {
+        Reject(bridge, interface, parser, byte, "Unable able to parse value. Missing object end.");
+        return;
+    }
+
+    // End of value
+    if ((parser->depth == 0) && (parser->string == false) && (parser->index > parser->valueIndex)) {
+        if ((byte == '}') || (byte == ',')) {
+            ParseObjectEnd(bridge, interface, parser, byte);
+            return;
+        }
+        if (IsWhiteSpace(byte)) {
+            parser->state = Ximu3CommandParserStateObjectEnd;
+            return;
+        }
+    }
+
+    // Add to buffer
+    if (Record(parser, byte) == false) {
+        Reject(bridge, interface, parser, byte, "Buffer overrun.");
+        return;
+    }
+
+    // Track strings and nesting
+    if (parser->string) {
+        if (parser->escape) {
+            parser->escape = false;
+        } else if (byte == '\\') {
+            parser->escape = true;
+        } else if (byte == '"') {
+            parser->string = false;
+        }
+    } else if (byte == '"') {
+        parser->string = true;
+        return;
+    } else if ((byte == '{') || (byte == '[')) {
+        parser->depth++;
+        return;
+    } else if ((byte == '}') || (byte == ']')) {
+        parser->depth--;
     } else {
-        ParseCommand(bridge, interface, message, messageSize);
+        return;
     }
+    if ((parser->depth != 0) || parser->string) {
+        return;
+    }
+    parser->state = Ximu3CommandParserStateObjectEnd;
+}
+
+/**
+ * @brief Parses the byte after a value. The value is terminated in place so
+ * that the next key follows the termination and the key/value pair is parsed.
+ * A comma continues the object as a batch. The
+ * object end dispatches the command or batch, or continues the array of a
+ * batch.
+ * @param bridge Bridge.
+ * @param interface Interface.
+ * @param parser Parser.
+ * @param byte Byte.
+ */
+static void ParseObjectEnd(const Ximu3CommandBridge * const bridge, const Ximu3CommandInterface * const interface, Ximu3CommandParser * const parser, const char byte) {
+    if ((byte != '}') && ((byte != ',') || parser->array)) {
+        Reject(bridge, interface, parser, byte, "Unable able to parse value. Missing object end.");
+        return;
+    }
+    if (Record(parser, '\0') == false) {
+        Reject(bridge, interface, parser, byte, "Buffer overrun.");
+        return;
+    }
+    if (byte == ',') {
+        parser->batch = true;
+    }
+    if (ParsePair(bridge, interface, parser) == false) {
+        parser->state = Ximu3CommandParserStateDiscard;
+        return;
+    }
+    parser->numberOfPairs++;
+    if (byte == ',') {
+        parser->state = Ximu3CommandParserStateKeyStart;
+        return;
+    }
+    if (parser->array) {
+        parser->state = Ximu3CommandParserStateArrayNext;
+        return;
+    }
+    Dispatch(bridge, interface, parser);
+    parser->state = Ximu3CommandParserStateDiscard;
+}
+
+/**
+ * @brief Parses the byte after an object of the array of a batch. A comma
+ * continues the array. The array end dispatches the batch.
+ * @param bridge Bridge.
+ * @param interface Interface.
+ * @param parser Parser.
+ * @param byte Byte.
+ */
+static void ParseArrayNext(const Ximu3CommandBridge * const bridge, const Ximu3CommandInterface * const interface, Ximu3CommandParser * const parser, const char byte) {
+    if (byte == ',') {
+        parser->state = Ximu3CommandParserStateArrayObjectStart;
+        return;
+    }
+    if (byte != ']') {
+        Reject(bridge, interface, parser, byte, "Unable able to parse batch. Missing array end.");
+        return;
+    }
+    Dispatch(bridge, interface, parser);
+    parser->state = Ximu3CommandParserStateDiscard;
+}
+
+/**
+ * @brief Parses the key/value pair once the value has ended. The key is looked
+ * up once and the pair is recorded before the value. The value of each pair of
+ * a batch is also validated so that an invalid batch is rejected before any
+ * pair is executed. The error response is sent and the message is discarded if
+ * the pair is invalid.
+ * @param bridge Bridge.
+ * @param interface Interface.
+ * @param parser Parser.
+ * @return True if the pair is valid.
+ */
+static bool ParsePair(const Ximu3CommandBridge * const bridge, const Ximu3CommandInterface * const interface, Ximu3CommandParser * const parser) {
+    char* const buffer = (char*) parser->buffer;
+    Aggregate aggregate = {.destination = buffer, .destinationSize = sizeof (parser->buffer) - sizeof (AGGREGATE_OVERFLOW), .length = 1};
+    Ximu3CommandResponse response = {.interface = interface, .context = bridge->context, .aggregate = &aggregate};
+    snprintf(response.key, sizeof (response.key), "%s", &buffer[parser->keyIndex]);
+    Pair pair;
+    const char* const error = Resolve(bridge, &response, &buffer[parser->valueIndex], parser->batch, &pair);
+    if (error != NULL) {
+        Ximu3CommandRespondError(&response, error); // overwrites the message
+        RespondAggregate(bridge, interface, &aggregate);
+        return false;
+    }
+    memcpy(&buffer[parser->valueIndex - sizeof (Pair)], &pair, sizeof (Pair));
+    return true;
+}
+
+/**
+ * @brief Records a byte of the message in the buffer.
+ * @param parser Parser.
+ * @param byte Byte.
+ * @return True if the byte was recorded.
+ */
+static bool Record(Ximu3CommandParser * const parser, const char byte) {
+    if (parser->index >= sizeof (parser->buffer)) {
+        return false;
+    }
+    parser->buffer[parser->index++] = byte;
+    return true;
 }
 
 /**
@@ -160,120 +546,402 @@ static void ParseMux(const Ximu3CommandBridge * const bridge, const Ximu3Command
 }
 
 /**
- * @brief Parse command message.
+ * @brief Parse binary command message. The first byte is followed by the
+ * byte-stuffed command ID and payload, and the termination. A response is sent
+ * only if the command ID includes the response flag.
  * @param bridge Bridge.
  * @param interface Interface.
  * @param message Message.
  * @param messageSize Message size.
  */
-static void ParseCommand(const Ximu3CommandBridge * const bridge, const Ximu3CommandInterface * const interface, uint8_t * const message, const size_t messageSize) {
+static void ParseBinary(const Ximu3CommandBridge * const bridge, const Ximu3CommandInterface * const interface, const uint8_t * const message, const size_t messageSize) {
 
-    // Terminate string
-    message[messageSize - 1] = '\0';
+    // Decode so that the command ID precedes a 4-byte aligned payload
+    uint8_t decoded[sizeof (uint32_t) + XIMU3_COMMAND_BINARY_PAYLOAD_SIZE] __attribute__((aligned(4)));
+    size_t decodedIndex = sizeof (uint32_t) - 1;
+    if ((messageSize < 3) || (BinaryDecode(decoded, sizeof (decoded), &decodedIndex, &message[1], messageSize - 2) != Ximu3ResultOk) || (decodedIndex < sizeof (uint32_t))) { // exclude first byte and termination
+        Error(bridge, "%s receive error. Invalid binary message.", interface->name);
+        return;
+    }
+    const uint8_t id = decoded[sizeof (uint32_t) - 1];
+    const void* const payload = &decoded[sizeof (uint32_t)];
+    const size_t numberOfBytes = decodedIndex - sizeof (uint32_t);
 #ifdef PRINT_MESSAGES
-    printf("%s RX %s\n", interface->name, (char*) message);
+    printf("%s RX binary 0x%02X %u bytes\n", interface->name, id, numberOfBytes);
 #endif
 
-    // Create JSON pointer
-    const char* buffer = (char*) message;
-    const char* * const json = &buffer;
+    // Execute
+    Ximu3CommandBinaryResponse response = {.numberOfBytes = 0};
+    const Ximu3CommandBinaryStatus status = ExecuteBinary(bridge, interface, id & ~XIMU3_COMMAND_BINARY_RESPONSE_FLAG, payload, numberOfBytes, &response);
 
-    // Parse object start
-    JsonResult result = JsonParseObjectStart(json);
-    if (result != JsonResultOk) {
-        Error(bridge, "%s receive error. Not a JSON object.", interface->name);
-        return;
+    // Respond
+    if ((id & XIMU3_COMMAND_BINARY_RESPONSE_FLAG) != 0) {
+        RespondBinary(bridge, interface, id, status, &response);
     }
+}
 
-    // Parse key
-    char key[XIMU3_KEY_SIZE];
-    result = JsonParseKey(json, key, sizeof (key));
-    if (result != JsonResultOk) {
-        Error(bridge, "%s receive error. Unable able to parse key. %s.", interface->name, JsonResultToString(result));
-        return;
+/**
+ * @brief Executes binary command.
+ * @param bridge Bridge.
+ * @param interface Interface.
+ * @param id Command ID without the response flag.
+ * @param payload Payload.
+ * @param numberOfBytes Number of bytes.
+ * @param response Response.
+ * @return Status.
+ */
+static Ximu3CommandBinaryStatus ExecuteBinary(const Ximu3CommandBridge * const bridge, const Ximu3CommandInterface * const interface, const uint8_t id, const void* const payload, const size_t numberOfBytes, Ximu3CommandBinaryResponse * const response) {
+    if ((bridge->binaryCommands == NULL) || (id >= bridge->numberOfBinaryCommands) || (bridge->binaryCommands[id].callback == NULL)) {
+        Error(bridge, "%s receive error. Unknown binary command 0x%02X.", interface->name, id);
+        return Ximu3CommandBinaryStatusUnknownCommand;
+    }
+    const Ximu3CommandBinaryMap * const command = &bridge->binaryCommands[id];
+    if (IsBinaryPayloadValid(command->type, numberOfBytes) == false) {
+        Error(bridge, "%s receive error. Invalid payload for binary command 0x%02X.", interface->name, id);
+        return Ximu3CommandBinaryStatusInvalidPayload;
+    }
+    if (command->callback(payload, numberOfBytes, response, bridge->context) != Ximu3ResultOk) {
+        return Ximu3CommandBinaryStatusError;
     }
+    return Ximu3CommandBinaryStatusOk;
+}
 
-    // Parse value
-    const char* value = *json;
-    result = JsonParse(json);
-    if (result != JsonResultOk) {
-        Error(bridge, "%s receive error. Unable able to parse value. %s.", interface->name, JsonResultToString(result));
-        return;
+/**
+ * @brief Returns true if the payload size is valid for the type.
+ * @param type Type.
+ * @param numberOfBytes Number of bytes.
+ * @return True if the payload size is valid for the type.
+ */
+static bool IsBinaryPayloadValid(const Ximu3CommandBinaryType type, const size_t numberOfBytes) {
+    switch (type) {
+        case Ximu3CommandBinaryTypeNone:
+            return numberOfBytes == 0;
+        case Ximu3CommandBinaryTypeUint8:
+            return numberOfBytes == sizeof (uint8_t);
+        case Ximu3CommandBinaryTypeUint32:
+            return numberOfBytes == sizeof (uint32_t);
+        case Ximu3CommandBinaryTypeFloat:
+            return numberOfBytes == sizeof (float);
+        case Ximu3CommandBinaryTypeBytes:
+            return true;
     }
+    return false; // avoid compiler warning
+}
 
-    // Parse object end
-    result = JsonParseObjectEnd(json);
-    if (result != JsonResultOk) {
-        Error(bridge, "%s receive error. JSON object is not a single key/value pair.", interface->name);
-        return;
+/**
+ * @brief Sends binary command response. The response is the first byte,
+ * followed by the byte-stuffed command ID, status, and payload, and the
+ * termination. The payload is sent only if the status is OK.
+ * @param bridge Bridge.
+ * @param interface Interface.
+ * @param id Command ID including the response flag.
+ * @param status Status.
+ * @param response Response.
+ */
+static void RespondBinary(const Ximu3CommandBridge * const bridge, const Ximu3CommandInterface * const interface, const uint8_t id, const Ximu3CommandBinaryStatus status, const Ximu3CommandBinaryResponse * const response) {
+    uint8_t message[1 + (2 * (2 + sizeof (response->payload))) + 1];
+    size_t messageIndex = 0;
+    BinaryWrite(message, sizeof (message), &messageIndex, XIMU3_COMMAND_BINARY_FIRST_BYTE);
+    BinaryWrite(message, sizeof (message), &messageIndex, id);
+    BinaryWrite(message, sizeof (message), &messageIndex, (uint8_t) status);
+    if (status == Ximu3CommandBinaryStatusOk) {
+        BinaryBytes(message, sizeof (message), &messageIndex, response->payload, response->numberOfBytes < sizeof (response->payload) ? response->numberOfBytes : sizeof (response->payload));
     }
+    BinaryTermination(message, sizeof (message), &messageIndex);
+    interface->write(message, messageIndex, bridge->context);
+}
 
-    // Initialise response
-    Ximu3CommandResponse response = {.interface = interface, .value = "null", .context = bridge->context};
-    snprintf(response.key, sizeof (response.key), "%s", key);
+/**
+ * @brief Dispatches the key/value pairs of a command or batch message once the
+ * message has ended. The parser has already decoded each key, recorded each
+ * key/value pair, and terminated each value in place so that each key is
+ * followed by its pair, its value, and then the next key. Every pair of a
+ * batch has already been validated so the pairs are executed without being
+ * parsed or looked up again. The pairs are executed in order, the write
+ * epilogue is called once for each setting written, and a single object of all
+ * responses is sent. The message is moved to the end of the parser buffer
+ * before it is executed and the responses are aggregated at the start so that
+ * they only overwrite pairs that have already been executed.
+ * @param bridge Bridge.
+ * @param interface Interface.
+ * @param parser Parser.
+ */
+static void Dispatch(const Ximu3CommandBridge * const bridge, const Ximu3CommandInterface * const interface, Ximu3CommandParser * const parser) {
+
+    // Move message to end of buffer
+    char* const buffer = (char*) parser->buffer;
+    const size_t offset = sizeof (parser->buffer) - parser->index;
+    const char* key = memmove(&buffer[offset], buffer, parser->index);
+
+    // Execute
+    const size_t maxDestinationSize = sizeof (parser->buffer) - sizeof (AGGREGATE_OVERFLOW); // keep space for overflow and termination
+    Aggregate aggregate = {.destination = buffer, .length = 1};
+    Ximu3CommandResponse response = {.interface = interface, .context = bridge->context, .aggregate = &aggregate};
+    bool written[XIMU3_NUMBER_OF_SETTINGS] = {false};
+    for (int index = 0; index < parser->numberOfPairs; index++) {
+        const char* const pairPointer = key + strlen(key) + 1;
+        const char* const value = pairPointer + sizeof (Pair);
+#ifdef PRINT_MESSAGES
+        printf("%s RX \"%s\":%s\n", interface->name, key, value);
+#endif
+        Pair pair;
+        memcpy(&pair, pairPointer, sizeof (Pair));
+        snprintf(response.key, sizeof (response.key), "%s", key);
+        snprintf(response.value, sizeof (response.value), "null");
+        aggregate.destinationSize = (size_t) (value - buffer); // responses must not overwrite the value or those that follow
+        if (aggregate.destinationSize > maxDestinationSize) {
+            aggregate.destinationSize = maxDestinationSize;
+        }
+        Execute(bridge, &response, pair, value, written);
+        key = value + strlen(value) + 1;
+    }
+
+    // Write epilogue
+    if (bridge->writeEpilogue != NULL) {
+        for (int index = 0; index < XIMU3_NUMBER_OF_SETTINGS; index++) {
+            if (written[index]) {
+                bridge->writeEpilogue(index, bridge->context);
+            }
+        }
+    }
+
+    // Respond
+    if ((parser->batch == false) && (aggregate.length == 1)) {
+        return; // command did not respond
+    }
+    RespondAggregate(bridge, interface, &aggregate);
+}
+
+/**
+ * @brief Sends the aggregate response as a single object.
+ * @param bridge Bridge.
+ * @param interface Interface.
+ * @param aggregate Aggregate response.
+ */
+static void RespondAggregate(const Ximu3CommandBridge * const bridge, const Ximu3CommandInterface * const interface, Aggregate * const aggregate) {
+    char* const destination = aggregate->destination;
+    if (aggregate->overflow) {
+        memcpy(&destination[aggregate->length], AGGREGATE_OVERFLOW, sizeof (AGGREGATE_OVERFLOW) - 1);
+        aggregate->length += sizeof (AGGREGATE_OVERFLOW) - 1;
+    }
+    destination[0] = '{';
+    if (aggregate->length == 1) {
+        destination[aggregate->length++] = '}';
+    } else {
+        destination[aggregate->length - 1] = '}'; // replace trailing comma
+    }
+    destination[aggregate->length] = '\n';
+    interface->write(destination, aggregate->length + 1, bridge->context);
+#ifdef PRINT_MESSAGES
+    printf("%s TX %.*s", interface->name, (int) (aggregate->length + 1), destination);
+#endif
+}
+
+/**
+ * @brief Resolves a key/value pair. The key is looked up to determine the type
+ * and index of the pair. The value of a command is parsed as the type of the
+ * command and the value of a setting is checked against the type of the
+ * setting if the pair is validated so that a batch is not partially executed
+ * if the value of a later pair is invalid.
+ * @param bridge Bridge.
+ * @param response Response. The value is used as the destination of strings.
+ * @param value Value.
+ * @param validate True to validate the value.
+ * @param pair Key/value pair.
+ * @return Error. NULL if the key/value pair is valid.
+ */
+static const char* Resolve(const Ximu3CommandBridge * const bridge, Ximu3CommandResponse * const response, const char* value, const bool validate, Pair * const pair) {
+
+    // Look up key
+    const char* const key = response->key;
+    char normalisedKey[XIMU3_KEY_SIZE];
+    KeyNormalise(key, normalisedKey, sizeof (normalisedKey));
+    const KeyHashEntry* const entry = KeyHashFind(normalisedKey);
 
     // Commands
-    for (int index = 0; index < bridge->numberOfCommands; index++) {
-        if (KeyCompare(key, bridge->commands[index].key)) {
-            bridge->commands[index].callback(&value, &response, bridge->context);
-            return;
+    const Ximu3CommandMap* const command = FindCommand(bridge, entry, normalisedKey);
+    if (command != NULL) {
+        pair->type = PairTypeCommand;
+        pair->index = (uint8_t) (command - bridge->commands);
+        if (validate == false) {
+            return NULL;
         }
+        JsonResult result;
+        switch (command->type) {
+            case Ximu3CommandTypeBoolean:
+                result = JsonParseBoolean(&value, NULL);
+                break;
+            case Ximu3CommandTypeNumber:
+                result = JsonParseNumber(&value, NULL);
+                break;
+            case Ximu3CommandTypeString:
+                result = JsonParseString(&value, response->value, sizeof (response->value), NULL);
+                break;
+            case Ximu3CommandTypeNull:
+            default:
+                result = JsonParseNull(&value);
+                break;
+        }
+        return result == JsonResultOk ? NULL : JsonResultToString(result);
     }
 
     // Settings
     if (bridge->settings != NULL) {
-        Ximu3SettingsIndex index;
-        if (Ximu3SettingsJsonGetIndex(bridge->settings, &index, key) == 0) {
+        if ((entry != NULL) && (entry->type == KeyHashTypeSetting)) {
+            pair->index = (uint8_t) entry->index;
 
             // Read
             if (JsonParseNull(&value) == JsonResultOk) {
-                Ximu3SettingsJsonGetValue(bridge->settings, response.value, sizeof (response.value), index);
-                Ximu3CommandRespond(&response);
-                return;
+                pair->type = PairTypeSettingRead;
+                return NULL;
             }
 
             // Write
-            const Metadata metadata = MetadataGet(bridge->settings, index);
+            pair->type = PairTypeSettingWrite;
+            const Metadata metadata = MetadataGet(bridge->settings, entry->index);
             const bool overrideReadOnly = bridge->overrideReadOnly == NULL ? false : bridge->overrideReadOnly(bridge->context);
             if (metadata.readOnly && (overrideReadOnly == false)) {
-                Ximu3CommandRespondError(&response, "Read-only");
-                return;
+                return "Read-only";
             }
-            result = Ximu3SettingsJsonSetKeyValue(bridge->settings, key, &value, overrideReadOnly);
-            if (result != JsonResultOk) {
-                Ximu3CommandRespondError(&response, JsonResultToString(result));
-                return;
+            if (validate == false) {
+                return NULL;
             }
-            if (bridge->writeEpilogue != NULL) {
-                bridge->writeEpilogue(index, bridge->context);
+            JsonType type;
+            JsonParseType(&value, &type);
+            switch (metadata.type) {
+                case MetadataTypeBool:
+                    return type == JsonTypeBoolean ? NULL : JsonResultToString(JsonResultUnexpectedType);
+                case MetadataTypeCharArray:
+                    return type == JsonTypeString ? NULL : JsonResultToString(JsonResultUnexpectedType);
+                case MetadataTypeFloat:
+                case MetadataTypeUint32:
+                    return type == JsonTypeNumber ? NULL : JsonResultToString(JsonResultUnexpectedType);
+                default:
+                    break;
             }
-            Ximu3SettingsJsonGetValue(bridge->settings, response.value, sizeof (response.value), index);
-            Ximu3CommandRespond(&response);
-            return;
+            return NULL;
         }
 
         // Enumerate
-        const char * keyPointer = key;
+        const char* keyPointer = key;
         if (KeyComparePartial(&keyPointer, "enumerate")) {
             int integer;
             if (sscanf(keyPointer, "%i", &integer) != 1) {
-                Ximu3CommandRespondError(&response, "Unable to parse index");
-                return;
-            }
-            if (Ximu3SettingsIndexFrom(&index, integer) == Ximu3ResultOk) {
-                Ximu3SettingsJsonGetObject(bridge->settings, response.value, sizeof (response.value), integer);
+                return "Unable to parse index";
             }
-            Ximu3CommandRespond(&response);
-            return;
+            Ximu3SettingsIndex index;
+            pair->type = PairTypeEnumerate;
+            pair->index = Ximu3SettingsIndexFrom(&index, integer) == Ximu3ResultOk ? (uint8_t) index : XIMU3_NUMBER_OF_SETTINGS;
+            return NULL;
         }
     }
 
     // Unknown command
     if (bridge->unknown != NULL) {
-        bridge->unknown(key, &value, &response, bridge->context);
+        pair->type = PairTypeUnknown;
+        pair->index = 0;
+        return NULL;
+    }
+    return "Unknown command";
+}
+
+/**
+ * @brief Appends a response to the aggregate response. Responses
+ * are discarded once the aggregate response has overflowed.
+ * @param aggregate Aggregate response.
+ * @param response Response.
+ */
+static void Append(Aggregate * const aggregate, const Ximu3CommandResponse * const response) {
+    if (aggregate->overflow) {
+        return;
+    }
+    const size_t available = aggregate->destinationSize - aggregate->length;
+    const int length = snprintf(&aggregate->destination[aggregate->length], available, "\"%s\":%s,", response->key, response->value);
+    if ((length < 0) || ((size_t) length >= available)) {
+        aggregate->overflow = true;
+        return;
+    }
+    aggregate->length += length;
+}
+
+/**
+ * @brief Executes a key/value pair.
+ * @param bridge Bridge.
+ * @param response Response. The key must be initialised.
+ * @param pair Key/value pair.
+ * @param value Value.
+ * @param written Settings written. The write epilogue is deferred to the
+ * caller.
+ */
+static void Execute(const Ximu3CommandBridge * const bridge, Ximu3CommandResponse * const response, const Pair pair, const char* value, bool * const written) {
+    switch ((PairType) pair.type) {
+        case PairTypeCommand:
+            bridge->commands[pair.index].callback(&value, response, bridge->context);
+            return;
+        case PairTypeSettingRead:
+            Ximu3SettingsJsonGetValue(bridge->settings, response->value, sizeof (response->value), (Ximu3SettingsIndex) pair.index);
+            Ximu3CommandRespond(response);
+            return;
+        case PairTypeSettingWrite:
+            ExecuteSettingWrite(bridge, response, (Ximu3SettingsIndex) pair.index, value, written);
+            return;
+        case PairTypeEnumerate:
+            if (pair.index < XIMU3_NUMBER_OF_SETTINGS) {
+                Ximu3SettingsJsonGetObject(bridge->settings, response->value, sizeof (response->value), (Ximu3SettingsIndex) pair.index);
+            }
+            Ximu3CommandRespond(response);
+            return;
+        case PairTypeUnknown:
+            bridge->unknown(response->key, &value, response, bridge->context);
+            return;
+    }
+}
+
+/**
+ * @brief Executes a key/value pair that writes a setting.
+ * @param bridge Bridge.
+ * @param response Response. The key must be initialised.
+ * @param index Index.
+ * @param value Value.
+ * @param written Settings written.
+ */
+static void ExecuteSettingWrite(const Ximu3CommandBridge * const bridge, Ximu3CommandResponse * const response, const Ximu3SettingsIndex index, const char* value, bool * const written) {
+    const bool overrideReadOnly = bridge->overrideReadOnly == NULL ? false : bridge->overrideReadOnly(bridge->context);
+    const JsonResult result = Ximu3SettingsJsonSetValue(bridge->settings, index, &value, overrideReadOnly);
+    if (result != JsonResultOk) {
+        Ximu3CommandRespondError(response, JsonResultToString(result));
         return;
     }
-    Ximu3CommandRespondError(&response, "Unknown command");
+    written[index] = true;
+    Ximu3SettingsJsonGetValue(bridge->settings, response->value, sizeof (response->value), index);
+    Ximu3CommandRespond(response);
+}
+
+/**
+ * @brief Finds the command. A command listed in Settings.json is found using
+ * the key hash if the command map is indexed by Ximu3CommandIndex. Otherwise,
+ * the command map is searched. Unused entries of the command map may be left
+ * empty.
+ * @param bridge Bridge.
+ * @param entry Key hash entry. NULL if the key was not found.
+ * @param normalisedKey Normalised key.
+ * @return Command. NULL if the key is not a command.
+ */
+static const Ximu3CommandMap* FindCommand(const Ximu3CommandBridge * const bridge, const KeyHashEntry * const entry, const char* const normalisedKey) {
+    if (entry != NULL) {
+        if (entry->type == KeyHashTypeSetting) {
+            return NULL;
+        }
+        if ((entry->index < bridge->numberOfCommands) && (bridge->commands[entry->index].key != NULL) && KeyCompare(normalisedKey, bridge->commands[entry->index].key)) {
+            return &bridge->commands[entry->index];
+        }
+    }
+    for (int index = 0; index < bridge->numberOfCommands; index++) {
+        if ((bridge->commands[index].key != NULL) && KeyCompare(normalisedKey, bridge->commands[index].key)) {
+            return &bridge->commands[index];
+        }
+    }
+    return NULL;
 }
 
 /**
@@ -342,16 +1010,13 @@ Ximu3Result Ximu3CommandParseNull(const char* * const value, Ximu3CommandRespons
 }
 
 /**
- * @brief Responds to command.
+ * @brief Responds to command. The response is appended to the aggregate
+ * response that is sent once every key/value pair of the message has been
+ * executed.
  * @param response Response.
  */
 void Ximu3CommandRespond(Ximu3CommandResponse * const response) {
-    char string[XIMU3_OBJECT_SIZE];
-    snprintf(string, sizeof (string), "{\"%s\":%s}\n", response->key, response->value);
-    response->interface->write(string, strlen(string), response->context);
-#ifdef PRINT_MESSAGES
-    printf("%s TX %s", response->interface->name, string);
-#endif
+    Append(response->aggregate, response);
 }
 
 /**
@@ -375,6 +1040,29 @@ void Ximu3CommandRespondError(Ximu3CommandResponse * const response, const char*
     Ximu3CommandRespond(response);
 }
 
+/**
+ * @brief Returns true if the byte is JSON white space, excluding the message
+ * termination.
+ * @param byte Byte.
+ * @return True if the byte is white space.
+ */
+static bool IsWhiteSpace(const char byte) {
+    return (byte == ' ') || (byte == '\t') || (byte == '\r');
+}
+
+/**
+ * @brief Rejects the message and discards the remainder of the line.
+ * @param bridge Bridge.
+ * @param interface Interface.
+ * @param parser Parser.
+ * @param byte Byte that caused the message to be rejected.
+ * @param error Error.
+ */
+static void Reject(const Ximu3CommandBridge * const bridge, const Ximu3CommandInterface * const interface, Ximu3CommandParser * const parser, const char byte, const char* const error) {
+    Error(bridge, "%s receive error. %s", interface->name, error);
+    parser->state = byte == '\n' ? Ximu3CommandParserStateObjectStart : Ximu3CommandParserStateDiscard;
+}
+
 /**
  * @param Error handler.
  * @param bridge Bridge.
@@ -10,6 +10,7 @@
 //------------------------------------------------------------------------------
 // Includes
 
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 #include "Ximu3Definitions.h"
@@ -18,6 +19,44 @@
 //------------------------------------------------------------------------------
 // Definitions
 
+/**
+ * @brief Parser state.
+ */
+typedef enum {
+    Ximu3CommandParserStateObjectStart,
+    Ximu3CommandParserStateArrayObjectStart,
+    Ximu3CommandParserStateKeyStart,
+    Ximu3CommandParserStateKey,
+    Ximu3CommandParserStateColon,
+    Ximu3CommandParserStateValueStart,
+    Ximu3CommandParserStateValue,
+    Ximu3CommandParserStateObjectEnd,
+    Ximu3CommandParserStateArrayNext,
+    Ximu3CommandParserStateMux,
+    Ximu3CommandParserStateBinary,
+    Ximu3CommandParserStateDiscard,
+} Ximu3CommandParserState;
+
+/**
+ * @brief Parser. Messages are parsed one byte at a time as data is received.
+ * The buffer holds the whole of a command, batch, mux, or binary message. Each
+ * key is decoded in place and each value is terminated in place as they end so
+ * that the message is not parsed again when it is executed.
+ */
+typedef struct {
+    Ximu3CommandParserState state; // private
+    uint8_t buffer[XIMU3_OBJECT_SIZE]; // private
+    size_t keyIndex; // private
+    size_t index; // private
+    size_t valueIndex; // private
+    int numberOfPairs; // private
+    int depth; // private
+    bool string; // private
+    bool escape; // private
+    bool array; // private
+    bool batch; // private
+} Ximu3CommandParser;
+
 /**
  * @brief Interface.
  */
@@ -25,8 +64,7 @@ typedef struct {
     const char* const name;
     size_t(*const read)(void* const destination, size_t numberOfBytes, void* const context);
     void (*const write) (const void* const data, const size_t numberOfBytes, void* const context);
-    uint8_t buffer[XIMU3_OBJECT_SIZE]; // private
-    size_t index; // private
+    Ximu3CommandParser parser; // private
 } Ximu3CommandInterface;
 
 /**
@@ -37,16 +75,86 @@ typedef struct {
     char key[XIMU3_KEY_SIZE];
     char value[XIMU3_VALUE_SIZE];
     void* context;
+    void* aggregate; // private
 } Ximu3CommandResponse;
 
+/**
+ * @brief Command value type. The value of a command in a batch is parsed as
+ * this type before any key/value pair of the batch is executed.
+ */
+typedef enum {
+    Ximu3CommandTypeNull,
+    Ximu3CommandTypeBoolean,
+    Ximu3CommandTypeNumber,
+    Ximu3CommandTypeString, // up to XIMU3_VALUE_SIZE bytes including termination
+} Ximu3CommandType;
+
 /**
  * @brief Map.
  */
 typedef struct {
     const char* const key;
+    const Ximu3CommandType type;
     void (*const callback) (const char* * const value, Ximu3CommandResponse * const response, void* const context);
 } Ximu3CommandMap;
 
+/**
+ * @brief Binary command first byte. Binary command messages are distinguished
+ * from JSON and mux messages by their first byte.
+ */
+#define XIMU3_COMMAND_BINARY_FIRST_BYTE (0x80 + 'C')
+
+/**
+ * @brief Binary command response flag. Set in the command ID of a binary
+ * command message to request a response.
+ */
+#define XIMU3_COMMAND_BINARY_RESPONSE_FLAG (0x80)
+
+/**
+ * @brief Binary command maximum payload size.
+ */
+#define XIMU3_COMMAND_BINARY_PAYLOAD_SIZE (64)
+
+/**
+ * @brief Binary command payload type. The payload size is validated before the
+ * callback is called.
+ */
+typedef enum {
+    Ximu3CommandBinaryTypeNone, // 0 bytes
+    Ximu3CommandBinaryTypeUint8, // 1 byte
+    Ximu3CommandBinaryTypeUint32, // 4 bytes, little-endian
+    Ximu3CommandBinaryTypeFloat, // 4 bytes, little-endian
+    Ximu3CommandBinaryTypeBytes, // up to XIMU3_COMMAND_BINARY_PAYLOAD_SIZE bytes
+} Ximu3CommandBinaryType;
+
+/**
+ * @brief Binary command response status.
+ */
+typedef enum {
+    Ximu3CommandBinaryStatusOk,
+    Ximu3CommandBinaryStatusError,
+    Ximu3CommandBinaryStatusUnknownCommand,
+    Ximu3CommandBinaryStatusInvalidPayload,
+} Ximu3CommandBinaryStatus;
+
+/**
+ * @brief Binary command response. The callback may write a payload that is
+ * sent if the response was requested.
+ */
+typedef struct {
+    uint8_t payload[XIMU3_COMMAND_BINARY_PAYLOAD_SIZE];
+    size_t numberOfBytes;
+} Ximu3CommandBinaryResponse;
+
+/**
+ * @brief Binary map. The map is indexed by command ID. The payload is 4-byte
+ * aligned.
+ */
+typedef struct {
+    const Ximu3CommandBinaryType type;
+    Ximu3Result(*const callback)(const void* const payload, const size_t numberOfBytes, Ximu3CommandBinaryResponse * const response, void* const context);
+} Ximu3CommandBinaryMap;
+
 /**
  * @brief Bridge.
  */
@@ -54,12 +162,14 @@ typedef struct {
     Ximu3CommandInterface * const interfaces;
     const int numberOfInterfaces;
     const Ximu3CommandMap * const commands;
-    const int numberOfCommands;
+    const int numberOfCommands; // up to 256
     Ximu3Settings * const settings; // NULL if unused
     bool (*const overrideReadOnly) (void* const context); // NULL if unused
     void (*const writeEpilogue) (const Ximu3SettingsIndex index, void* const context); // NULL if unused
     void (*const unknown) (const char* const key, const char* * const value, Ximu3CommandResponse * const response, void* const context); // NULL if unused
     Ximu3Result(*const mux)(const Ximu3CommandInterface * const interface, const uint8_t channel, const void* const message, const size_t messageSize); // NULL if unused
+    const Ximu3CommandBinaryMap * const binaryCommands; // NULL if unused
+    const int numberOfBinaryCommands;
     void (*const error) (const char* const error, void* const context); // NULL if unused
     void* context;
 } Ximu3CommandBridge;
@@ -68,7 +178,7 @@ typedef struct {
 // Function declarations
 
 void Ximu3CommandTasks(Ximu3CommandBridge * const bridge);
-void Ximu3CommandReceive(const Ximu3CommandBridge * const bridge, const Ximu3CommandInterface * const interface, const void* const data, const size_t numberOfBytes);
+void Ximu3CommandReceive(const Ximu3CommandBridge * const bridge, Ximu3CommandInterface * const interface, const void* const data, const size_t numberOfBytes);
 Ximu3Result Ximu3CommandParseString(const char* * const value, Ximu3CommandResponse * const response, char* const destination, const size_t destinationSize, size_t * const numberOfBytes);
 Ximu3Result Ximu3CommandParseNumber(const char* * const value, Ximu3CommandResponse * const response, float *const number);
 Ximu3Result Ximu3CommandParseBoolean(const char* * const value, Ximu3CommandResponse * const response, bool *const boolean);
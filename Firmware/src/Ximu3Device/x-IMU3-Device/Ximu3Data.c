@@ -7,20 +7,11 @@
 //------------------------------------------------------------------------------
 // Includes
 
+#include "Ascii.h"
 #include "Binary.h"
 #include <ctype.h>
-#include <inttypes.h>
-#include <stdio.h>
 #include "Ximu3Data.h"
 
-//------------------------------------------------------------------------------
-// Definitions
-
-/**
- * @brief Float format used by ASCII data messages.
- */
-#define FLOAT_FORMAT "%.4f"
-
 //------------------------------------------------------------------------------
 // Functions
 
@@ -53,16 +44,17 @@ size_t Ximu3DataInertialBinary(void* const destination, const size_t destination
  * @return Message size.
  */
 size_t Ximu3DataInertialAscii(void* const destination, const size_t destinationSize, const Ximu3DataInertial * const data) {
-    return snprintf(destination, destinationSize, "I,%" PRIu64 ","
-            FLOAT_FORMAT "," FLOAT_FORMAT "," FLOAT_FORMAT ","
-            FLOAT_FORMAT "," FLOAT_FORMAT "," FLOAT_FORMAT "\n",
-            data->timestamp,
-            data->gyroscopeX,
-            data->gyroscopeY,
-            data->gyroscopeZ,
-            data->accelerometerX,
-            data->accelerometerY,
-            data->accelerometerZ);
+    size_t destinationIndex = 0;
+    AsciiFirstByte(destination, destinationSize, &destinationIndex, 'I');
+    AsciiTimestamp(destination, destinationSize, &destinationIndex, data->timestamp);
+    AsciiFloat(destination, destinationSize, &destinationIndex, data->gyroscopeX);
+    AsciiFloat(destination, destinationSize, &destinationIndex, data->gyroscopeY);
+    AsciiFloat(destination, destinationSize, &destinationIndex, data->gyroscopeZ);
+    AsciiFloat(destination, destinationSize, &destinationIndex, data->accelerometerX);
+    AsciiFloat(destination, destinationSize, &destinationIndex, data->accelerometerY);
+    AsciiFloat(destination, destinationSize, &destinationIndex, data->accelerometerZ);
+    AsciiTermination(destination, destinationSize, &destinationIndex);
+    return destinationIndex;
 }
 
 /**
@@ -91,12 +83,14 @@ size_t Ximu3DataMagnetometerBinary(void* const destination, const size_t destina
  * @return Message size.
  */
 size_t Ximu3DataMagnetometerAscii(void* const destination, const size_t destinationSize, const Ximu3DataMagnetometer * const data) {
-    return snprintf(destination, destinationSize, "M,%" PRIu64 ","
-            FLOAT_FORMAT "," FLOAT_FORMAT "," FLOAT_FORMAT "\n",
-            data->timestamp,
-            data->x,
-            data->y,
-            data->z);
+    size_t destinationIndex = 0;
+    AsciiFirstByte(destination, destinationSize, &destinationIndex, 'M');
+    AsciiTimestamp(destination, destinationSize, &destinationIndex, data->timestamp);
+    AsciiFloat(destination, destinationSize, &destinationIndex, data->x);
+    AsciiFloat(destination, destinationSize, &destinationIndex, data->y);
+    AsciiFloat(destination, destinationSize, &destinationIndex, data->z);
+    AsciiTermination(destination, destinationSize, &destinationIndex);
+    return destinationIndex;
 }
 
 /**
@@ -126,13 +120,15 @@ size_t Ximu3DataQuaternionBinary(void* const destination, const size_t destinati
  * @return Message size.
  */
 size_t Ximu3DataQuaternionAscii(void* const destination, const size_t destinationSize, const Ximu3DataQuaternion * const data) {
-    return snprintf(destination, destinationSize, "Q,%" PRIu64 ","
-            FLOAT_FORMAT "," FLOAT_FORMAT "," FLOAT_FORMAT "," FLOAT_FORMAT "\n",
-            data->timestamp,
-            data->w,
-            data->x,
-            data->y,
-            data->z);
+    size_t destinationIndex = 0;
+    AsciiFirstByte(destination, destinationSize, &destinationIndex, 'Q');
+    AsciiTimestamp(destination, destinationSize, &destinationIndex, data->timestamp);
+    AsciiFloat(destination, destinationSize, &destinationIndex, data->w);
+    AsciiFloat(destination, destinationSize, &destinationIndex, data->x);
+    AsciiFloat(destination, destinationSize, &destinationIndex, data->y);
+    AsciiFloat(destination, destinationSize, &destinationIndex, data->z);
+    AsciiTermination(destination, destinationSize, &destinationIndex);
+    return destinationIndex;
 }
 
 /**
@@ -167,20 +163,20 @@ size_t Ximu3DataRotationMatrixBinary(void* const destination, const size_t desti
  * @return Message size.
  */
 size_t Ximu3DataRotationMatrixAscii(void* const destination, const size_t destinationSize, const Ximu3DataRotationMatrix * const data) {
-    return snprintf(destination, destinationSize, "R,%" PRIu64 ","
-            FLOAT_FORMAT "," FLOAT_FORMAT "," FLOAT_FORMAT ","
-            FLOAT_FORMAT "," FLOAT_FORMAT "," FLOAT_FORMAT ","
-            FLOAT_FORMAT "," FLOAT_FORMAT "," FLOAT_FORMAT "\n",
-            data->timestamp,
-            data->xx,
-            data->xy,
-            data->xz,
-            data->yx,
-            data->yy,
-            data->yz,
-            data->zx,
-            data->zy,
-            data->zz);
+    size_t destinationIndex = 0;
+    AsciiFirstByte(destination, destinationSize, &destinationIndex, 'R');
+    AsciiTimestamp(destination, destinationSize, &destinationIndex, data->timestamp);
+    AsciiFloat(destination, destinationSize, &destinationIndex, data->xx);
+    AsciiFloat(destination, destinationSize, &destinationIndex, data->xy);
+    AsciiFloat(destination, destinationSize, &destinationIndex, data->xz);
+    AsciiFloat(destination, destinationSize, &destinationIndex, data->yx);
+    AsciiFloat(destination, destinationSize, &destinationIndex, data->yy);
+    AsciiFloat(destination, destinationSize, &destinationIndex, data->yz);
+    AsciiFloat(destination, destinationSize, &destinationIndex, data->zx);
+    AsciiFloat(destination, destinationSize, &destinationIndex, data->zy);
+    AsciiFloat(destination, destinationSize, &destinationIndex, data->zz);
+    AsciiTermination(destination, destinationSize, &destinationIndex);
+    return destinationIndex;
 }
 
 /**
@@ -209,12 +205,14 @@ size_t Ximu3DataEulerAnglesBinary(void* const destination, const size_t destinat
  * @return Message size.
  */
 size_t Ximu3DataEulerAnglesAscii(void* const destination, const size_t destinationSize, const Ximu3DataEulerAngles * const data) {
-    return snprintf(destination, destinationSize, "A,%" PRIu64 ","
-            FLOAT_FORMAT "," FLOAT_FORMAT "," FLOAT_FORMAT "\n",
-            data->timestamp,
-            data->roll,
-            data->pitch,
-            data->yaw);
+    size_t destinationIndex = 0;
+    AsciiFirstByte(destination, destinationSize, &destinationIndex, 'A');
+    AsciiTimestamp(destination, destinationSize, &destinationIndex, data->timestamp);
+    AsciiFloat(destination, destinationSize, &destinationIndex, data->roll);
+    AsciiFloat(destination, destinationSize, &destinationIndex, data->pitch);
+    AsciiFloat(destination, destinationSize, &destinationIndex, data->yaw);
+    AsciiTermination(destination, destinationSize, &destinationIndex);
+    return destinationIndex;
 }
 
 /**
@@ -247,17 +245,18 @@ size_t Ximu3DataLinearAccelerationBinary(void* const destination, const size_t d
  * @return Message size.
  */
 size_t Ximu3DataLinearAccelerationAscii(void* const destination, const size_t destinationSize, const Ximu3DataLinearAcceleration * const data) {
-    return snprintf(destination, destinationSize, "L,%" PRIu64 ","
-            FLOAT_FORMAT "," FLOAT_FORMAT "," FLOAT_FORMAT "," FLOAT_FORMAT ","
-            FLOAT_FORMAT "," FLOAT_FORMAT "," FLOAT_FORMAT "\n",
-            data->timestamp,
-            data->quaternionW,
-            data->quaternionX,
-            data->quaternionY,
-            data->quaternionZ,
-            data->linearAccelerationX,
-            data->linearAccelerationY,
-            data->linearAccelerationZ);
+    size_t destinationIndex = 0;
+    AsciiFirstByte(destination, destinationSize, &destinationIndex, 'L');
+    AsciiTimestamp(destination, destinationSize, &destinationIndex, data->timestamp);
+    AsciiFloat(destination, destinationSize, &destinationIndex, data->quaternionW);
+    AsciiFloat(destination, destinationSize, &destinationIndex, data->quaternionX);
+    AsciiFloat(destination, destinationSize, &destinationIndex, data->quaternionY);
+    AsciiFloat(destination, destinationSize, &destinationIndex, data->quaternionZ);
+    AsciiFloat(destination, destinationSize, &destinationIndex, data->linearAccelerationX);
+    AsciiFloat(destination, destinationSize, &destinationIndex, data->linearAccelerationY);
+    AsciiFloat(destination, destinationSize, &destinationIndex, data->linearAccelerationZ);
+    AsciiTermination(destination, destinationSize, &destinationIndex);
+    return destinationIndex;
 }
 
 /**
@@ -290,17 +289,18 @@ size_t Ximu3DataEarthAccelerationBinary(void* const destination, const size_t de
  * @return Message size.
  */
 size_t Ximu3DataEarthAccelerationAscii(void* const destination, const size_t destinationSize, const Ximu3DataEarthAcceleration * const data) {
-    return snprintf(destination, destinationSize, "E,%" PRIu64 ","
-            FLOAT_FORMAT "," FLOAT_FORMAT "," FLOAT_FORMAT "," FLOAT_FORMAT ","
-            FLOAT_FORMAT "," FLOAT_FORMAT "," FLOAT_FORMAT "\n",
-            data->timestamp,
-            data->quaternionW,
-            data->quaternionX,
-            data->quaternionY,
-            data->quaternionZ,
-            data->earthAccelerationX,
-            data->earthAccelerationY,
-            data->earthAccelerationZ);
+    size_t destinationIndex = 0;
+    AsciiFirstByte(destination, destinationSize, &destinationIndex, 'E');
+    AsciiTimestamp(destination, destinationSize, &destinationIndex, data->timestamp);
+    AsciiFloat(destination, destinationSize, &destinationIndex, data->quaternionW);
+    AsciiFloat(destination, destinationSize, &destinationIndex, data->quaternionX);
+    AsciiFloat(destination, destinationSize, &destinationIndex, data->quaternionY);
+    AsciiFloat(destination, destinationSize, &destinationIndex, data->quaternionZ);
+    AsciiFloat(destination, destinationSize, &destinationIndex, data->earthAccelerationX);
+    AsciiFloat(destination, destinationSize, &destinationIndex, data->earthAccelerationY);
+    AsciiFloat(destination, destinationSize, &destinationIndex, data->earthAccelerationZ);
+    AsciiTermination(destination, destinationSize, &destinationIndex);
+    return destinationIndex;
 }
 
 /**
@@ -330,13 +330,15 @@ size_t Ximu3DataAhrsStatusBinary(void* const destination, const size_t destinati
  * @return Message size.
  */
 size_t Ximu3DataAhrsStatusAscii(void* const destination, const size_t destinationSize, const Ximu3DataAhrsStatus * const data) {
-    return snprintf(destination, destinationSize, "U,%" PRIu64 ","
-            FLOAT_FORMAT "," FLOAT_FORMAT "," FLOAT_FORMAT "," FLOAT_FORMAT "\n",
-            data->timestamp,
-            (float) data->initialising,
-            (float) data->angularRateRecovery,
-            (float) data->accelerationRecovery,
-            (float) data->magneticRecovery);
+    size_t destinationIndex = 0;
+    AsciiFirstByte(destination, destinationSize, &destinationIndex, 'U');
+    AsciiTimestamp(destination, destinationSize, &destinationIndex, data->timestamp);
+    AsciiFloat(destination, destinationSize, &destinationIndex, (float) data->initialising);
+    AsciiFloat(destination, destinationSize, &destinationIndex, (float) data->angularRateRecovery);
+    AsciiFloat(destination, destinationSize, &destinationIndex, (float) data->accelerationRecovery);
+    AsciiFloat(destination, destinationSize, &destinationIndex, (float) data->magneticRecovery);
+    AsciiTermination(destination, destinationSize, &destinationIndex);
+    return destinationIndex;
 }
 
 /**
@@ -365,12 +367,14 @@ size_t Ximu3DataHighGAccelerometerBinary(void* const destination, const size_t d
  * @return Message size.
  */
 size_t Ximu3DataHighGAccelerometerAscii(void* const destination, const size_t destinationSize, const Ximu3DataHighGAccelerometer * const data) {
-    return snprintf(destination, destinationSize, "H,%" PRIu64 ","
-            FLOAT_FORMAT "," FLOAT_FORMAT "," FLOAT_FORMAT "\n",
-            data->timestamp,
-            data->x,
-            data->y,
-            data->z);
+    size_t destinationIndex = 0;
+    AsciiFirstByte(destination, destinationSize, &destinationIndex, 'H');
+    AsciiTimestamp(destination, destinationSize, &destinationIndex, data->timestamp);
+    AsciiFloat(destination, destinationSize, &destinationIndex, data->x);
+    AsciiFloat(destination, destinationSize, &destinationIndex, data->y);
+    AsciiFloat(destination, destinationSize, &destinationIndex, data->z);
+    AsciiTermination(destination, destinationSize, &destinationIndex);
+    return destinationIndex;
 }
 
 /**
@@ -397,9 +401,12 @@ size_t Ximu3DataTemperatureBinary(void* const destination, const size_t destinat
  * @return Message size.
  */
 size_t Ximu3DataTemperatureAscii(void* const destination, const size_t destinationSize, const Ximu3DataTemperature * const data) {
-    return snprintf(destination, destinationSize, "T,%" PRIu64 "," FLOAT_FORMAT "\n",
-            data->timestamp,
-            data->temperature);
+    size_t destinationIndex = 0;
+    AsciiFirstByte(destination, destinationSize, &destinationIndex, 'T');
+    AsciiTimestamp(destination, destinationSize, &destinationIndex, data->timestamp);
+    AsciiFloat(destination, destinationSize, &destinationIndex, data->temperature);
+    AsciiTermination(destination, destinationSize, &destinationIndex);
+    return destinationIndex;
 }
 
 /**
@@ -428,11 +435,14 @@ size_t Ximu3DataBatteryBinary(void* const destination, const size_t destinationS
  * @return Message size.
  */
 size_t Ximu3DataBatteryAscii(void* const destination, const size_t destinationSize, const Ximu3DataBattery * const data) {
-    return snprintf(destination, destinationSize, "B,%" PRIu64 "," FLOAT_FORMAT "," FLOAT_FORMAT "," FLOAT_FORMAT "\n",
-            data->timestamp,
-            data->percentage,
-            data->voltage,
-            data->chargingStatus);
+    size_t destinationIndex = 0;
+    AsciiFirstByte(destination, destinationSize, &destinationIndex, 'B');
+    AsciiTimestamp(destination, destinationSize, &destinationIndex, data->timestamp);
+    AsciiFloat(destination, destinationSize, &destinationIndex, data->percentage);
+    AsciiFloat(destination, destinationSize, &destinationIndex, data->voltage);
+    AsciiFloat(destination, destinationSize, &destinationIndex, data->chargingStatus);
+    AsciiTermination(destination, destinationSize, &destinationIndex);
+    return destinationIndex;
 }
 
 /**
@@ -460,10 +470,13 @@ size_t Ximu3DataRssiBinary(void* const destination, const size_t destinationSize
  * @return Message size.
  */
 size_t Ximu3DataRssiAscii(void* const destination, const size_t destinationSize, const Ximu3DataRssi * const data) {
-    return snprintf(destination, destinationSize, "W,%" PRIu64 "," FLOAT_FORMAT "," FLOAT_FORMAT "\n",
-            data->timestamp,
-            data->percentage,
-            data->power);
+    size_t destinationIndex = 0;
+    AsciiFirstByte(destination, destinationSize, &destinationIndex, 'W');
+    AsciiTimestamp(destination, destinationSize, &destinationIndex, data->timestamp);
+    AsciiFloat(destination, destinationSize, &destinationIndex, data->percentage);
+    AsciiFloat(destination, destinationSize, &destinationIndex, data->power);
+    AsciiTermination(destination, destinationSize, &destinationIndex);
+    return destinationIndex;
 }
 
 /**
@@ -477,9 +490,7 @@ size_t Ximu3DataSerialAccessoryBinary(void* const destination, const size_t dest
     size_t destinationIndex = 0;
     BinaryFirstByte(destination, destinationSize, &destinationIndex, 'S');
     BinaryTimestamp(destination, destinationSize, &destinationIndex, data->timestamp);
-    for (size_t index = 0; index < data->numberOfBytes; index++) {
-        BinaryWrite(destination, destinationSize, &destinationIndex, data->data[index]);
-    }
+    BinaryBytes(destination, destinationSize, &destinationIndex, data->data, data->numberOfBytes);
     BinaryTermination(destination, destinationSize, &destinationIndex);
     return destinationIndex;
 }
@@ -492,12 +503,15 @@ size_t Ximu3DataSerialAccessoryBinary(void* const destination, const size_t dest
  * @return Message size.
  */
 size_t Ximu3DataSerialAccessoryAscii(void* const destination, const size_t destinationSize, const Ximu3DataSerialAccessory * const data) {
-    size_t destinationIndex = snprintf(destination, destinationSize, "S,%" PRIu64 ",", data->timestamp);
+    size_t destinationIndex = 0;
+    AsciiFirstByte(destination, destinationSize, &destinationIndex, 'S');
+    AsciiTimestamp(destination, destinationSize, &destinationIndex, data->timestamp);
+    AsciiCharacter(destination, destinationSize, &destinationIndex, ',');
     for (size_t index = 0; index < data->numberOfBytes; index++) {
         const uint8_t byte = data->data[index];
-        ((uint8_t*) destination)[destinationIndex++] = ((char) byte < 0) || (isprint(byte) == 0) ? '?' : byte;
+        AsciiCharacter(destination, destinationSize, &destinationIndex, ((char) byte < 0) || (isprint(byte) == 0) ? '?' : byte);
     }
-    ((uint8_t*) destination)[destinationIndex++] = '\n';
+    AsciiTermination(destination, destinationSize, &destinationIndex);
     return destinationIndex;
 }
 
@@ -525,7 +539,12 @@ size_t Ximu3DataNotificationBinary(void* const destination, const size_t destina
  * @return Message size.
  */
 size_t Ximu3DataNotificationAscii(void* const destination, const size_t destinationSize, const Ximu3DataNotification * const data) {
-    return snprintf(destination, destinationSize, "N,%" PRIu64 ",%s\n", data->timestamp, data->string);
+    size_t destinationIndex = 0;
+    AsciiFirstByte(destination, destinationSize, &destinationIndex, 'N');
+    AsciiTimestamp(destination, destinationSize, &destinationIndex, data->timestamp);
+    AsciiString(destination, destinationSize, &destinationIndex, data->string);
+    AsciiTermination(destination, destinationSize, &destinationIndex);
+    return destinationIndex;
 }
 
 /**
@@ -552,7 +571,12 @@ size_t Ximu3DataErrorBinary(void* const destination, const size_t destinationSiz
  * @return Message size.
  */
 size_t Ximu3DataErrorAscii(void* const destination, const size_t destinationSize, const Ximu3DataError * const data) {
-    return snprintf(destination, destinationSize, "F,%" PRIu64 ",%s\n", data->timestamp, data->string);
+    size_t destinationIndex = 0;
+    AsciiFirstByte(destination, destinationSize, &destinationIndex, 'F');
+    AsciiTimestamp(destination, destinationSize, &destinationIndex, data->timestamp);
+    AsciiString(destination, destinationSize, &destinationIndex, data->string);
+    AsciiTermination(destination, destinationSize, &destinationIndex);
+    return destinationIndex;
 }
 
 //------------------------------------------------------------------------------
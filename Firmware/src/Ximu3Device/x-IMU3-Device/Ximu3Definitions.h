@@ -16,6 +16,8 @@
 
 #define XIMU3_NUMBER_OF_SETTINGS 8
 
+#define XIMU3_NUMBER_OF_COMMANDS 9
+
 #define XIMU3_MUX_HEADER_SIZE 2
 
 typedef enum {
@@ -45,6 +47,18 @@ typedef enum {
     Ximu3SettingsIndexMessageRateDivisor,
 } Ximu3SettingsIndex;
 
+typedef enum {
+    Ximu3CommandIndexPing,
+    Ximu3CommandIndexBlink,
+    Ximu3CommandIndexStrobe,
+    Ximu3CommandIndexNote,
+    Ximu3CommandIndexBatch,
+    Ximu3CommandIndexCompression,
+    Ximu3CommandIndexThroughput,
+    Ximu3CommandIndexClockSync,
+    Ximu3CommandIndexStatistics,
+} Ximu3CommandIndex;
+
 Ximu3Result Ximu3SettingsIndexFrom(Ximu3SettingsIndex * const index, const int integer);
 
 #endif
@@ -8,6 +8,7 @@
 // Includes
 
 #include "KeyCompare.h"
+#include "KeyHash.h"
 #include "Metadata.h"
 #include <stdio.h>
 #include <string.h>
@@ -27,20 +28,22 @@ static JsonResult ParseUint32(Ximu3Settings * const settings, const Ximu3Setting
 // Functions
 
 /**
- * @brief Gets the index.
+ * @brief Gets the index. The key is found using the key hash generated by
+ * generate.py.
  * @param settings Settings.
  * @param index_ Index.
  * @param key Key.
  * @return Result.
  */
 Ximu3Result Ximu3SettingsJsonGetIndex(Ximu3Settings * const settings, Ximu3SettingsIndex * const index_, const char* const key) {
-    for (int index = 0; index < XIMU3_NUMBER_OF_SETTINGS; index++) {
-        if (KeyCompare(key, MetadataGet(settings, index).key)) {
-            *index_ = index;
-            return Ximu3ResultOk;
-        }
+    char normalisedKey[XIMU3_KEY_SIZE];
+    KeyNormalise(key, normalisedKey, sizeof (normalisedKey));
+    const KeyHashEntry* const entry = KeyHashFind(normalisedKey);
+    if ((entry == NULL) || (entry->type != KeyHashTypeSetting)) {
+        return Ximu3ResultError;
     }
-    return Ximu3ResultError;
+    *index_ = entry->index;
+    return Ximu3ResultOk;
 }
 
 /**
@@ -160,17 +163,23 @@ static void Append(char* const destination, const size_t destinationSize, const
  * @return Result.
  */
 JsonResult Ximu3SettingsJsonSetKeyValue(Ximu3Settings * const settings, const char* const key, const char* * const value, const bool overrideReadOnly) {
-
-    // Get index
     Ximu3SettingsIndex index;
     if (Ximu3SettingsJsonGetIndex(settings, &index, key) != 0) {
         return JsonResultOk;
     }
+    return Ximu3SettingsJsonSetValue(settings, index, value, overrideReadOnly);
+}
 
-    // Get metadata
+/**
+ * @brief Sets the value of a setting from its index.
+ * @param settings Settings.
+ * @param index Index.
+ * @param value Value.
+ * @param overrideReadOnly True to override read-only.
+ * @return Result.
+ */
+JsonResult Ximu3SettingsJsonSetValue(Ximu3Settings * const settings, const Ximu3SettingsIndex index, const char* * const value, const bool overrideReadOnly) {
     const Metadata metadata = MetadataGet(settings, index);
-
-    // Parse value
     switch (metadata.type) {
         case MetadataTypeBool:
             return ParseBool(settings, index, value, overrideReadOnly);
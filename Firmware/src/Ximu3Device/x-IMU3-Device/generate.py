@@ -25,12 +25,24 @@ def snake_case(string):
     return "_".join([w.lower() for w in split_words(string)])
 
 
+def normalise(string):
+    return "".join(split_words(string)).lower()  # equivalent to KeyNormalise
+
+
+def key_hash(seed, string):
+    hash = seed
+    for character in string.encode():
+        hash = ((hash ^ character) * 16777619) & 0xFFFFFFFF  # FNV-1a
+    return hash
+
+
 # Load Settings.json
 with open("Settings.json") as file:
     object = json.load(file)
 
     includes = object["includes"]
     settings = object["settings"]
+    commands = object.get("commands", [])
 
 # Generate Ximu3Definitions.h
 includes = "\n".join([f"#include {i}" for i in includes])
@@ -39,6 +51,8 @@ values = "\n".join([f"    {s['declaration'].replace('name', camel_case(s['name']
 
 index = "\n".join([f"    Ximu3SettingsIndex{pascal_case(s['name'])}," for s in settings])
 
+command_index = "\n".join([f"    Ximu3CommandIndex{pascal_case(c)}," for c in commands])
+
 contents = f"""\
 {preamble}
 
@@ -57,6 +71,8 @@ contents = f"""\
 
 #define XIMU3_NUMBER_OF_SETTINGS {len(settings)}
 
+#define XIMU3_NUMBER_OF_COMMANDS {len(commands)}
+
 #define XIMU3_MUX_HEADER_SIZE 2
 
 typedef enum {{
@@ -72,6 +88,10 @@ typedef enum {{
 {index}
 }} Ximu3SettingsIndex;
 
+typedef enum {{
+{command_index}
+}} Ximu3CommandIndex;
+
 Ximu3Result Ximu3SettingsIndexFrom(Ximu3SettingsIndex * const index, const int integer);
 
 #endif
@@ -230,3 +250,85 @@ Metadata MetadataGet(Ximu3Settings * const settings, const Ximu3SettingsIndex in
 
 with open("Metadata.c", "w") as file:
     file.write(contents)
+
+# Generate KeyHash.h
+contents = f"""\
+{preamble}
+
+#ifndef KEY_HASH_H
+#define KEY_HASH_H
+
+typedef enum {{
+    KeyHashTypeSetting,
+    KeyHashTypeCommand,
+}} KeyHashType;
+
+typedef struct {{
+    const char* const key;
+    const KeyHashType type;
+    const int index;
+}} KeyHashEntry;
+
+const KeyHashEntry* KeyHashFind(const char* const key);
+
+#endif
+"""
+
+with open("KeyHash.h", "w") as file:
+    file.write(contents)
+
+# Generate KeyHash.c
+entries = [(normalise(snake_case(s["name"])), "KeyHashTypeSetting", f"Ximu3SettingsIndex{pascal_case(s['name'])}") for s in settings]
+entries += [(normalise(c), "KeyHashTypeCommand", f"Ximu3CommandIndex{pascal_case(c)}") for c in commands]
+
+keys = [e[0] for e in entries]
+duplicates = sorted(set([k for k in keys if keys.count(k) > 1]))
+if duplicates:
+    raise Exception(f"Duplicate keys: {', '.join(duplicates)}")
+
+table_size = 1
+while table_size < (2 * len(entries)):
+    table_size *= 2
+
+seed = 2166136261  # FNV-1a offset basis
+while len(set([key_hash(seed, k) & (table_size - 1) for k in keys])) != len(keys):
+    seed = (seed + 1) & 0xFFFFFFFF
+
+table = "\n".join([f'    [{key_hash(seed, k) & (table_size - 1)}] = {{"{k}", {t}, {i}}},' for k, t, i in sorted(entries, key=lambda e: key_hash(seed, e[0]) & (table_size - 1))])
+
+contents = f"""\
+{preamble}
+
+#include "KeyHash.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "Ximu3Definitions.h"
+
+#define SEED 0x{seed:08X}u
+
+#define MASK {table_size - 1}u
+
+static const KeyHashEntry entries[MASK + 1] = {{
+{table}
+}};
+
+static uint32_t Hash(const char* key) {{
+    uint32_t hash = SEED;
+    while (*key != '\\0') {{
+        hash = (hash ^ (uint8_t) *key++) * 16777619u;
+    }}
+    return hash;
+}}
+
+const KeyHashEntry* KeyHashFind(const char* const key) {{
+    const KeyHashEntry* const entry = &entries[Hash(key) & MASK];
+    if ((entry->key == NULL) || (strcmp(entry->key, key) != 0)) {{
+        return NULL;
+    }}
+    return entry;
+}}
+"""
+
+with open("KeyHash.c", "w") as file:
+    file.write(contents)
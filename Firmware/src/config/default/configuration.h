@@ -94,13 +94,13 @@ extern "C" {
 // *****************************************************************************
 // *****************************************************************************
 /* Maximum instances of CDC function driver */
-#define USB_DEVICE_CDC_INSTANCES_NUMBER                     1U
+#define USB_DEVICE_CDC_INSTANCES_NUMBER                     2U
 
 
 /* CDC Transfer Queue Size for both read and
    write. Applicable to all instances of the
    function driver */
-#define USB_DEVICE_CDC_QUEUE_DEPTH_COMBINED                 3U
+#define USB_DEVICE_CDC_QUEUE_DEPTH_COMBINED                13U
 
 /*** USB Driver Configuration ***/
 
@@ -126,7 +126,7 @@ extern "C" {
 
 
 /* Number of Endpoints used */
-#define DRV_USBHS_ENDPOINTS_NUMBER                        4U
+#define DRV_USBHS_ENDPOINTS_NUMBER                        6U
 
 /* The USB Device Layer will not initialize the USB Driver */
 #define USB_DEVICE_DRIVER_INITIALIZE_EXPLICIT
@@ -137,6 +137,9 @@ extern "C" {
 /* EP0 size in bytes */
 #define USB_DEVICE_EP0_BUFFER_SIZE                          64U
 
+/* Enable SOF Events */
+#define USB_DEVICE_SOF_EVENT_ENABLE
+
 
 
 
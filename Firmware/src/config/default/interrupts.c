@@ -68,6 +68,7 @@
 // Section: System Interrupt Vector declarations
 // *****************************************************************************
 // *****************************************************************************
+void CORE_TIMER_Handler (void);
 void TIMER_3_Handler (void);
 void UART1_RX_Handler (void);
 void UART1_TX_Handler (void);
@@ -84,6 +85,11 @@ void ADC_EOS_Handler (void);
 // Section: System Interrupt Vector definitions
 // *****************************************************************************
 // *****************************************************************************
+void __attribute__((used)) __ISR(_CORE_TIMER_VECTOR, ipl1SRS) CORE_TIMER_Handler (void)
+{
+    EventsCoreTimerInterruptHandler();
+}
+
 void __attribute__((used)) __ISR(_TIMER_3_VECTOR, ipl7SRS) TIMER_3_Handler (void)
 {
     Timer3InterruptHandler();
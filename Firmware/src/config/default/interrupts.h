@@ -59,6 +59,7 @@
 void DRV_USBHS_InterruptHandler( void );
 void DRV_USBHS_DMAInterruptHandler( void );
 
+void EventsCoreTimerInterruptHandler(void);
 void Timer3InterruptHandler(void);
 void Uart1RxInterruptHandler(void);
 void Uart1TxInterruptHandler(void);
@@ -14,7 +14,9 @@
 // Includes
 
 #include "Adc/Adc.h"
+#include "ClockSync/ClockSync.h"
 #include "definitions.h"
+#include "Events/Events.h"
 #include "Leds/Leds.h"
 #include "NeoPixels/NeoPixels.h"
 #include "Notification/Notification.h"
@@ -25,6 +27,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include "Tap/Tap.h"
+#include "Throughput/Throughput.h"
 #include "Timer/Timer.h"
 #include "Uart/Uart1.h"
 #include "Uart/Uart2.h"
@@ -47,20 +50,35 @@ int main(void) {
 
     // Initialise modules
     TimerInitialise();
+    EventsInitialise();
     AdcInitialise();
     Spi1DmaTxInitialise(&neoPixelsSpiSettings);
     Uart1Initialise(&uartSettingsDefault);
 
     // Main program loop
     while (true) {
-        SYS_Tasks();
+        SYS_Tasks(); // USB VBUS level is polled so must run on every event
 
-        // Application tasks
-        LedsTasks();
-        NotificationTasks();
-        TapTasks();
-        UsbCdcTasks();
-        Ximu3DeviceTasks();
+        // Application tasks of pending events
+        const Events events = EventsGet();
+        if ((events & EventsTick) != 0) {
+            LedsTasks();
+            NotificationTasks();
+        }
+        if ((events & EventsAdc) != 0) {
+            TapTasks();
+        }
+        if ((events & (EventsTick | EventsThroughput)) != 0) {
+            ThroughputTasks();
+        }
+        if ((events & (EventsTick | EventsUsb)) != 0) {
+            ClockSyncTasks();
+            UsbCdcTasks();
+            Ximu3DeviceTasks();
+        }
+
+        // Wait in idle mode until next event
+        EventsWait();
     }
     return (EXIT_FAILURE);
 }
@@ -10,6 +10,7 @@
 //------------------------------------------------------------------------------
 // Includes
 
+#include "Events/Events.h"
 #include "Spi/Spi1DmaTx.h"
 
 //------------------------------------------------------------------------------
@@ -24,8 +25,22 @@
 #define UART2_READ_BUFFER_SIZE              (16)
 #define UART2_WRITE_BUFFER_SIZE             (4096)
 
-#define USB_CDC_READ_BUFFER_SIZE            (4096)
-#define USB_CDC_WRITE_BUFFER_SIZE           (4096)
+// Rate for each transfer size may be recorded by rebuilding and running
+// Throughput/throughput_test.py --sweep
+#define USB_CDC_PACKET_SIZE                 (512)
+#define USB_CDC_READ_TRANSFER_SIZE          (1 * USB_CDC_PACKET_SIZE)
+#define USB_CDC_READ_TRANSFERS              (2)
+#define USB_CDC_WRITE_TRANSFER_SIZE         (4 * USB_CDC_PACKET_SIZE)
+#define USB_CDC_WRITE_TRANSFERS             (4)
+#define USB_CDC_READ_BUFFER_SIZE            (8 * USB_CDC_READ_TRANSFER_SIZE)
+#define USB_CDC_PRIORITY_WRITE_BUFFER_SIZE  (1024)
+#define USB_CDC_WRITE_BUFFER_SIZE           (2 * USB_CDC_WRITE_TRANSFERS * USB_CDC_WRITE_TRANSFER_SIZE)
+#define USB_CDC_WRITE_RESERVE_SIZE          (1024)
+#define USB_CDC_EVENT()                     EventsSet(EventsUsb)
+
+#define USB_HID_REPORT_SIZE                 (8)
+#define USB_HID_WRITE_BUFFER_SIZE           (32 * USB_HID_REPORT_SIZE)
+#define USB_HID_EVENT()                     EventsSet(EventsUsb)
 
 #endif
 
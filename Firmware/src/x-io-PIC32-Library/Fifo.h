@@ -19,18 +19,30 @@
 
 /**
  * @brief FIFO structure. All structure members are private except for
- * initialisation.
+ * initialisation. The optional reserve size is the number of additional bytes
+ * allocated after dataSize so that FifoWriteReserve may provide contiguous
+ * space across wraparound. Data may be read in place using FifoReadPeek,
+ * FifoReadAcquire, and FifoReadRelease. These functions must not be mixed with
+ * other read functions. The FIFO may be written to by one context and read
+ * from by another. Each index is published with release semantics after the
+ * data is written or read, and the index of the other context is loaded with
+ * acquire semantics.
  * Example:
  * @code
  * uint8_t data[1024];
  * Fifo fifo = {.data = data, .dataSize = sizeof (data)};
+ *
+ * uint8_t dataWithReserve[1024 + 256];
+ * Fifo fifoWithReserve = {.data = dataWithReserve, .dataSize = 1024, .reserveSize = 256};
  * @endcode
  */
 typedef struct {
     volatile uint8_t * const data;
     const size_t dataSize;
-    volatile size_t writeIndex;
-    volatile size_t readIndex;
+    const size_t reserveSize;
+    size_t writeIndex;
+    size_t readIndex;
+    size_t acquireIndex;
 } Fifo;
 
 /**
@@ -50,11 +62,12 @@ typedef enum {
  * @return Number of bytes available in the buffer.
  */
 static inline __attribute__((always_inline)) size_t FifoAvailableRead(Fifo * const fifo) {
-    const size_t writeIndex = fifo->writeIndex; // avoid asynchronous hazard
-    if (writeIndex < fifo->readIndex) {
-        return fifo->dataSize - fifo->readIndex + writeIndex;
+    const size_t writeIndex = __atomic_load_n(&fifo->writeIndex, __ATOMIC_ACQUIRE);
+    const size_t readIndex = __atomic_load_n(&fifo->readIndex, __ATOMIC_RELAXED);
+    if (writeIndex < readIndex) {
+        return fifo->dataSize - readIndex + writeIndex;
     } else {
-        return writeIndex - fifo->readIndex;
+        return writeIndex - readIndex;
     }
 }
 
@@ -84,10 +97,10 @@ static inline __attribute__((always_inline)) size_t FifoRead(Fifo * const fifo,
         memcpy(destination, (void*) &fifo->data[fifo->readIndex], numberOfBytesBeforeWraparound);
         const size_t numberOfBytesAfterWraparound = numberOfBytes - numberOfBytesBeforeWraparound;
         memcpy(&((uint8_t*) destination)[numberOfBytesBeforeWraparound], (void*) fifo->data, numberOfBytesAfterWraparound);
-        fifo->readIndex = numberOfBytesAfterWraparound;
+        __atomic_store_n(&fifo->readIndex, numberOfBytesAfterWraparound, __ATOMIC_RELEASE);
     } else {
         memcpy(destination, (void*) &fifo->data[fifo->readIndex], numberOfBytes);
-        fifo->readIndex += numberOfBytes;
+        __atomic_store_n(&fifo->readIndex, fifo->readIndex + numberOfBytes, __ATOMIC_RELEASE);
     }
     return numberOfBytes;
 }
@@ -100,9 +113,8 @@ static inline __attribute__((always_inline)) size_t FifoRead(Fifo * const fifo,
  */
 static inline __attribute__((always_inline)) uint8_t FifoReadByte(Fifo * const fifo) {
     const uint8_t byte = fifo->data[fifo->readIndex];
-    if (++fifo->readIndex >= fifo->dataSize) {
-        fifo->readIndex = 0;
-    }
+    const size_t readIndex = fifo->readIndex + 1;
+    __atomic_store_n(&fifo->readIndex, readIndex >= fifo->dataSize ? 0 : readIndex, __ATOMIC_RELEASE);
     return byte;
 }
 
@@ -112,11 +124,12 @@ static inline __attribute__((always_inline)) uint8_t FifoReadByte(Fifo * const f
  * @return Space available in the buffer.
  */
 static inline __attribute__((always_inline)) size_t FifoAvailableWrite(Fifo * const fifo) {
-    const size_t readIndex = fifo->readIndex; // avoid asynchronous hazard
-    if (fifo->writeIndex < readIndex) {
-        return (fifo->dataSize - 1) - (fifo->dataSize - readIndex) - fifo->writeIndex;
+    const size_t readIndex = __atomic_load_n(&fifo->readIndex, __ATOMIC_ACQUIRE);
+    const size_t writeIndex = __atomic_load_n(&fifo->writeIndex, __ATOMIC_RELAXED);
+    if (writeIndex < readIndex) {
+        return (fifo->dataSize - 1) - (fifo->dataSize - readIndex) - writeIndex;
     } else {
-        return (fifo->dataSize - 1) - (fifo->writeIndex - readIndex);
+        return (fifo->dataSize - 1) - (writeIndex - readIndex);
     }
 }
 
@@ -140,10 +153,10 @@ static inline __attribute__((always_inline)) FifoResult FifoWrite(Fifo * const f
         memcpy((void*) &fifo->data[fifo->writeIndex], data, numberOfBytesBeforeWraparound);
         const size_t numberOfBytesAfterWraparound = numberOfBytes - numberOfBytesBeforeWraparound;
         memcpy((void*) fifo->data, &((uint8_t*) data)[numberOfBytesBeforeWraparound], numberOfBytesAfterWraparound);
-        fifo->writeIndex = numberOfBytesAfterWraparound;
+        __atomic_store_n(&fifo->writeIndex, numberOfBytesAfterWraparound, __ATOMIC_RELEASE);
     } else {
         memcpy((void*) &fifo->data[fifo->writeIndex], data, numberOfBytes);
-        fifo->writeIndex += numberOfBytes;
+        __atomic_store_n(&fifo->writeIndex, fifo->writeIndex + numberOfBytes, __ATOMIC_RELEASE);
     }
     return FifoResultOk;
 }
@@ -163,18 +176,91 @@ static inline __attribute__((always_inline)) FifoResult FifoWriteByte(Fifo * con
 
     // Write byte
     fifo->data[fifo->writeIndex] = byte;
-    if (++fifo->writeIndex >= fifo->dataSize) {
-        fifo->writeIndex = 0;
-    }
+    const size_t writeIndex = fifo->writeIndex + 1;
+    __atomic_store_n(&fifo->writeIndex, writeIndex >= fifo->dataSize ? 0 : writeIndex, __ATOMIC_RELEASE);
     return FifoResultOk;
 }
 
 /**
- * @brief Clears the FIFO.
+ * @brief Returns a pointer to contiguous space that may be written to directly
+ * and committed using FifoWriteCommit. Space beyond the wraparound is provided
+ * by the reserve.
+ * @param fifo FIFO structure.
+ * @param numberOfBytes Number of contiguous bytes available.
+ * @return Pointer to space.
+ */
+static inline __attribute__((always_inline)) void* FifoWriteReserve(Fifo * const fifo, size_t * const numberOfBytes) {
+    const size_t availableWrite = FifoAvailableWrite(fifo);
+    const size_t contiguous = (fifo->dataSize - fifo->writeIndex) + fifo->reserveSize;
+    *numberOfBytes = availableWrite < contiguous ? availableWrite : contiguous;
+    return (void*) &fifo->data[fifo->writeIndex];
+}
+
+/**
+ * @brief Commits data written to space provided by FifoWriteReserve. The number
+ * of bytes must not exceed the number of bytes reserved.
+ * @param fifo FIFO structure.
+ * @param numberOfBytes Number of bytes.
+ */
+static inline __attribute__((always_inline)) void FifoWriteCommit(Fifo * const fifo, const size_t numberOfBytes) {
+    size_t writeIndex = fifo->writeIndex + numberOfBytes;
+    if (writeIndex >= fifo->dataSize) {
+        writeIndex -= fifo->dataSize;
+        memcpy((void*) fifo->data, (void*) &fifo->data[fifo->dataSize], writeIndex); // move bytes written to reserve
+    }
+    __atomic_store_n(&fifo->writeIndex, writeIndex, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Returns a pointer to contiguous data that has not been acquired. The
+ * data may be read in place and acquired using FifoReadAcquire.
+ * @param fifo FIFO structure.
+ * @param numberOfBytes Number of contiguous bytes available.
+ * @return Pointer to data.
+ */
+static inline __attribute__((always_inline)) const void* FifoReadPeek(Fifo * const fifo, size_t * const numberOfBytes) {
+    const size_t writeIndex = __atomic_load_n(&fifo->writeIndex, __ATOMIC_ACQUIRE);
+    *numberOfBytes = (writeIndex < fifo->acquireIndex ? fifo->dataSize : writeIndex) - fifo->acquireIndex;
+    return (const void*) &fifo->data[fifo->acquireIndex];
+}
+
+/**
+ * @brief Acquires data provided by FifoReadPeek. The data remains in the FIFO
+ * until released using FifoReadRelease so that it may continue to be read in
+ * place. The number of bytes must not exceed the number of bytes provided.
+ * @param fifo FIFO structure.
+ * @param numberOfBytes Number of bytes.
+ */
+static inline __attribute__((always_inline)) void FifoReadAcquire(Fifo * const fifo, const size_t numberOfBytes) {
+    size_t acquireIndex = fifo->acquireIndex + numberOfBytes;
+    if (acquireIndex >= fifo->dataSize) {
+        acquireIndex -= fifo->dataSize;
+    }
+    fifo->acquireIndex = acquireIndex;
+}
+
+/**
+ * @brief Releases acquired data so that the space may be written to. Data must
+ * be released in the order that it was acquired.
+ * @param fifo FIFO structure.
+ * @param numberOfBytes Number of bytes.
+ */
+static inline __attribute__((always_inline)) void FifoReadRelease(Fifo * const fifo, const size_t numberOfBytes) {
+    size_t readIndex = fifo->readIndex + numberOfBytes;
+    if (readIndex >= fifo->dataSize) {
+        readIndex -= fifo->dataSize;
+    }
+    __atomic_store_n(&fifo->readIndex, readIndex, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Clears the FIFO, including data acquired but not yet released.
  * @param fifo FIFO structure.
  */
 static inline __attribute__((always_inline)) void FifoClear(Fifo * const fifo) {
-    fifo->readIndex = fifo->writeIndex;
+    const size_t writeIndex = __atomic_load_n(&fifo->writeIndex, __ATOMIC_ACQUIRE);
+    fifo->acquireIndex = writeIndex;
+    __atomic_store_n(&fifo->readIndex, writeIndex, __ATOMIC_RELEASE);
 }
 
 #endif
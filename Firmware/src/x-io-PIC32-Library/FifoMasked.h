@@ -0,0 +1,281 @@
+/**
+ * @file FifoMasked.h
+ * @author Seb Madgwick
+ * @brief Asynchronous FIFO buffer with a power-of-two capacity. The write and
+ * read indices are free-running and addressed with a mask so that no index
+ * wraparound is required and the entire capacity may be used. The functions
+ * are equivalent to those of Fifo.h.
+ */
+
+#ifndef FIFO_MASKED_H
+#define FIFO_MASKED_H
+
+//------------------------------------------------------------------------------
+// Includes
+
+#include "Fifo.h"
+#include "FifoStatistics.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+//------------------------------------------------------------------------------
+// Definitions
+
+/**
+ * @brief FIFO structure. All structure members are private and must be
+ * initialised using FIFO_MASKED or FIFO_MASKED_WITH_STATISTICS. The optional
+ * statistics are updated by the write functions. The optional reserve size
+ * is the number of additional bytes allocated after the capacity so that
+ * FifoMaskedWriteReserve may provide contiguous space across wraparound. Data
+ * may be read in place using FifoMaskedReadPeek, FifoMaskedReadAcquire, and
+ * FifoMaskedReadRelease. These functions must not be mixed with other read
+ * functions. The FIFO may be written to by one context and read from by
+ * another. Each index is published with release semantics after the data is
+ * written or read, and the index of the other context is loaded with acquire
+ * semantics.
+ * Example:
+ * @code
+ * uint8_t data[1024];
+ * FifoMasked fifo = FIFO_MASKED(data, sizeof (data), 0);
+ *
+ * uint8_t dataWithReserve[1024 + 256];
+ * FifoMasked fifoWithReserve = FIFO_MASKED(dataWithReserve, 1024, 256);
+ * @endcode
+ */
+typedef struct {
+    volatile uint8_t * const data;
+    const size_t mask;
+    const size_t reserveSize;
+    FifoStatistics * const statistics;
+    size_t writeIndex;
+    size_t readIndex;
+    size_t acquireIndex;
+} FifoMasked;
+
+/**
+ * @brief FIFO structure initialiser with statistics. Compilation will fail if
+ * the capacity is not a power of two.
+ * @param data_ Data.
+ * @param capacity_ Capacity. Must be a power of two.
+ * @param reserveSize_ Reserve size.
+ * @param statistics_ Statistics. May be NULL.
+ */
+#define FIFO_MASKED_WITH_STATISTICS(data_, capacity_, reserveSize_, statistics_) { \
+    .data = (data_), \
+    .mask = ((capacity_) - 1) + (0 * sizeof (char[((capacity_) & ((capacity_) - 1)) == 0 ? 1 : -1])), \
+    .reserveSize = (reserveSize_), \
+    .statistics = (statistics_), \
+}
+
+/**
+ * @brief FIFO structure initialiser. Compilation will fail if the capacity is
+ * not a power of two.
+ * @param data_ Data.
+ * @param capacity_ Capacity. Must be a power of two.
+ * @param reserveSize_ Reserve size.
+ */
+#define FIFO_MASKED(data_, capacity_, reserveSize_) FIFO_MASKED_WITH_STATISTICS(data_, capacity_, reserveSize_, NULL)
+
+//------------------------------------------------------------------------------
+// Inline functions
+
+/**
+ * @brief Returns the number of bytes available to read from the FIFO.
+ * @param fifo FIFO structure.
+ * @return Number of bytes available in the buffer.
+ */
+static inline __attribute__((always_inline)) size_t FifoMaskedAvailableRead(FifoMasked * const fifo) {
+    const size_t writeIndex = __atomic_load_n(&fifo->writeIndex, __ATOMIC_ACQUIRE);
+    return writeIndex - __atomic_load_n(&fifo->readIndex, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Reads data from the FIFO.
+ * @param fifo FIFO structure.
+ * @param destination Destination.
+ * @param numberOfBytes Number of bytes.
+ * @return Number of bytes read.
+ */
+static inline __attribute__((always_inline)) size_t FifoMaskedRead(FifoMasked * const fifo, void* const destination, size_t numberOfBytes) {
+
+    // Do nothing if no bytes available to read
+    const size_t bytesAvailable = FifoMaskedAvailableRead(fifo);
+    if (bytesAvailable == 0) {
+        return 0;
+    }
+
+    // Limit number of bytes to number available
+    if (numberOfBytes > bytesAvailable) {
+        numberOfBytes = bytesAvailable;
+    }
+
+    // Read data
+    const size_t index = fifo->readIndex & fifo->mask;
+    const size_t numberOfBytesBeforeWraparound = (fifo->mask + 1) - index;
+    if (numberOfBytes > numberOfBytesBeforeWraparound) {
+        memcpy(destination, (void*) &fifo->data[index], numberOfBytesBeforeWraparound);
+        memcpy(&((uint8_t*) destination)[numberOfBytesBeforeWraparound], (void*) fifo->data, numberOfBytes - numberOfBytesBeforeWraparound);
+    } else {
+        memcpy(destination, (void*) &fifo->data[index], numberOfBytes);
+    }
+    __atomic_store_n(&fifo->readIndex, fifo->readIndex + numberOfBytes, __ATOMIC_RELEASE);
+    return numberOfBytes;
+}
+
+/**
+ * @brief Reads a byte from the FIFO. This function must only be called if
+ * there are bytes available to read.
+ * @param fifo FIFO structure.
+ * @return Byte.
+ */
+static inline __attribute__((always_inline)) uint8_t FifoMaskedReadByte(FifoMasked * const fifo) {
+    const uint8_t byte = fifo->data[fifo->readIndex & fifo->mask];
+    __atomic_store_n(&fifo->readIndex, fifo->readIndex + 1, __ATOMIC_RELEASE);
+    return byte;
+}
+
+/**
+ * @brief Returns the space available to write to the FIFO.
+ * @param fifo FIFO structure.
+ * @return Space available in the buffer.
+ */
+static inline __attribute__((always_inline)) size_t FifoMaskedAvailableWrite(FifoMasked * const fifo) {
+    const size_t readIndex = __atomic_load_n(&fifo->readIndex, __ATOMIC_ACQUIRE);
+    return (fifo->mask + 1) - (__atomic_load_n(&fifo->writeIndex, __ATOMIC_RELAXED) - readIndex);
+}
+
+/**
+ * @brief Writes data to the FIFO.
+ * @param fifo FIFO structure.
+ * @param data Data.
+ * @param numberOfBytes Number of bytes.
+ * @return Result.
+ */
+static inline __attribute__((always_inline)) FifoResult FifoMaskedWrite(FifoMasked * const fifo, const void* const data, const size_t numberOfBytes) {
+
+    // Do nothing if not enough space available
+    const size_t availableWrite = FifoMaskedAvailableWrite(fifo);
+    if (numberOfBytes > availableWrite) {
+        FifoStatisticsOverflow(fifo->statistics);
+        return FifoResultError;
+    }
+
+    // Write data
+    const size_t index = fifo->writeIndex & fifo->mask;
+    const size_t numberOfBytesBeforeWraparound = (fifo->mask + 1) - index;
+    if (numberOfBytes > numberOfBytesBeforeWraparound) {
+        memcpy((void*) &fifo->data[index], data, numberOfBytesBeforeWraparound);
+        memcpy((void*) fifo->data, &((uint8_t*) data)[numberOfBytesBeforeWraparound], numberOfBytes - numberOfBytesBeforeWraparound);
+    } else {
+        memcpy((void*) &fifo->data[index], data, numberOfBytes);
+    }
+    __atomic_store_n(&fifo->writeIndex, fifo->writeIndex + numberOfBytes, __ATOMIC_RELEASE);
+    FifoStatisticsOccupancy(fifo->statistics, ((fifo->mask + 1) - availableWrite) + numberOfBytes);
+    return FifoResultOk;
+}
+
+/**
+ * @brief Writes a byte to the FIFO.
+ * @param fifo FIFO structure.
+ * @param byte Byte.
+ * @return Result.
+ */
+static inline __attribute__((always_inline)) FifoResult FifoMaskedWriteByte(FifoMasked * const fifo, const uint8_t byte) {
+
+    // Do nothing if not enough space available
+    const size_t availableWrite = FifoMaskedAvailableWrite(fifo);
+    if (availableWrite == 0) {
+        FifoStatisticsOverflow(fifo->statistics);
+        return FifoResultError;
+    }
+
+    // Write byte
+    fifo->data[fifo->writeIndex & fifo->mask] = byte;
+    __atomic_store_n(&fifo->writeIndex, fifo->writeIndex + 1, __ATOMIC_RELEASE);
+    FifoStatisticsOccupancy(fifo->statistics, ((fifo->mask + 1) - availableWrite) + 1);
+    return FifoResultOk;
+}
+
+/**
+ * @brief Returns a pointer to contiguous space that may be written to directly
+ * and committed using FifoMaskedWriteCommit. Space beyond the wraparound is
+ * provided by the reserve.
+ * @param fifo FIFO structure.
+ * @param numberOfBytes Number of contiguous bytes available.
+ * @return Pointer to space.
+ */
+static inline __attribute__((always_inline)) void* FifoMaskedWriteReserve(FifoMasked * const fifo, size_t * const numberOfBytes) {
+    const size_t availableWrite = FifoMaskedAvailableWrite(fifo);
+    const size_t index = fifo->writeIndex & fifo->mask;
+    const size_t contiguous = ((fifo->mask + 1) - index) + fifo->reserveSize;
+    *numberOfBytes = availableWrite < contiguous ? availableWrite : contiguous;
+    return (void*) &fifo->data[index];
+}
+
+/**
+ * @brief Commits data written to space provided by FifoMaskedWriteReserve. The
+ * number of bytes must not exceed the number of bytes reserved.
+ * @param fifo FIFO structure.
+ * @param numberOfBytes Number of bytes.
+ */
+static inline __attribute__((always_inline)) void FifoMaskedWriteCommit(FifoMasked * const fifo, const size_t numberOfBytes) {
+    const size_t end = (fifo->writeIndex & fifo->mask) + numberOfBytes;
+    if (end > (fifo->mask + 1)) {
+        memcpy((void*) fifo->data, (void*) &fifo->data[fifo->mask + 1], end - (fifo->mask + 1)); // move bytes written to reserve
+    }
+    __atomic_store_n(&fifo->writeIndex, fifo->writeIndex + numberOfBytes, __ATOMIC_RELEASE);
+    FifoStatisticsOccupancy(fifo->statistics, fifo->writeIndex - __atomic_load_n(&fifo->readIndex, __ATOMIC_ACQUIRE));
+}
+
+/**
+ * @brief Returns a pointer to contiguous data that has not been acquired. The
+ * data may be read in place and acquired using FifoMaskedReadAcquire.
+ * @param fifo FIFO structure.
+ * @param numberOfBytes Number of contiguous bytes available.
+ * @return Pointer to data.
+ */
+static inline __attribute__((always_inline)) const void* FifoMaskedReadPeek(FifoMasked * const fifo, size_t * const numberOfBytes) {
+    const size_t available = __atomic_load_n(&fifo->writeIndex, __ATOMIC_ACQUIRE) - fifo->acquireIndex;
+    const size_t index = fifo->acquireIndex & fifo->mask;
+    const size_t contiguous = (fifo->mask + 1) - index;
+    *numberOfBytes = available < contiguous ? available : contiguous;
+    return (const void*) &fifo->data[index];
+}
+
+/**
+ * @brief Acquires data provided by FifoMaskedReadPeek. The data remains in the
+ * FIFO until released using FifoMaskedReadRelease so that it may continue to
+ * be read in place. The number of bytes must not exceed the number of bytes
+ * provided.
+ * @param fifo FIFO structure.
+ * @param numberOfBytes Number of bytes.
+ */
+static inline __attribute__((always_inline)) void FifoMaskedReadAcquire(FifoMasked * const fifo, const size_t numberOfBytes) {
+    fifo->acquireIndex += numberOfBytes;
+}
+
+/**
+ * @brief Releases acquired data so that the space may be written to. Data must
+ * be released in the order that it was acquired.
+ * @param fifo FIFO structure.
+ * @param numberOfBytes Number of bytes.
+ */
+static inline __attribute__((always_inline)) void FifoMaskedReadRelease(FifoMasked * const fifo, const size_t numberOfBytes) {
+    __atomic_store_n(&fifo->readIndex, fifo->readIndex + numberOfBytes, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Clears the FIFO, including data acquired but not yet released.
+ * @param fifo FIFO structure.
+ */
+static inline __attribute__((always_inline)) void FifoMaskedClear(FifoMasked * const fifo) {
+    const size_t writeIndex = __atomic_load_n(&fifo->writeIndex, __ATOMIC_ACQUIRE);
+    fifo->acquireIndex = writeIndex;
+    __atomic_store_n(&fifo->readIndex, writeIndex, __ATOMIC_RELEASE);
+}
+
+#endif
+
+//------------------------------------------------------------------------------
+// End of file
@@ -0,0 +1,158 @@
+/**
+ * @file FifoRecord.h
+ * @author Seb Madgwick
+ * @brief Asynchronous FIFO buffer of fixed-size records. Records are written
+ * and read in place so that no data is copied. Records never straddle the
+ * wraparound. The number of records must be a power of two so that the
+ * free-running indices may be addressed with a mask. Each index is published
+ * with release semantics after the record is written or read, and the index
+ * of the other context is loaded with acquire semantics.
+ */
+
+#ifndef FIFO_RECORD_H
+#define FIFO_RECORD_H
+
+//------------------------------------------------------------------------------
+// Includes
+
+#include "FifoStatistics.h"
+#include <stddef.h>
+#include <stdint.h>
+
+//------------------------------------------------------------------------------
+// Definitions
+
+/**
+ * @brief FIFO structure. All structure members are private and must be
+ * initialised using FIFO_RECORD or FIFO_RECORD_WITH_STATISTICS. The optional
+ * statistics are updated by the write functions. Occupancy is in records.
+ * Example:
+ * @code
+ * Record records[64];
+ * FifoRecord fifo = FIFO_RECORD(records);
+ *
+ * Record * const record = FifoRecordWriteReserve(&fifo);
+ * if (record != NULL) {
+ *     record->value = value;
+ *     FifoRecordWriteCommit(&fifo);
+ * }
+ * @endcode
+ */
+typedef struct {
+    uint8_t * const data;
+    const size_t recordSize;
+    const size_t mask;
+    FifoStatistics * const statistics;
+    size_t writeIndex;
+    size_t readIndex;
+} FifoRecord;
+
+/**
+ * @brief Number of records in an array of records.
+ * @param records_ Array of records.
+ */
+#define FIFO_RECORD_NUMBER_OF_RECORDS(records_) (sizeof (records_) / sizeof ((records_)[0]))
+
+/**
+ * @brief FIFO structure initialiser with statistics. Compilation will fail if
+ * the number of records is not a power of two.
+ * @param records_ Array of records.
+ * @param statistics_ Statistics. May be NULL.
+ */
+#define FIFO_RECORD_WITH_STATISTICS(records_, statistics_) { \
+    .data = (uint8_t *) (records_), \
+    .recordSize = sizeof ((records_)[0]), \
+    .mask = (FIFO_RECORD_NUMBER_OF_RECORDS(records_) - 1) + (0 * sizeof (char[(FIFO_RECORD_NUMBER_OF_RECORDS(records_) & (FIFO_RECORD_NUMBER_OF_RECORDS(records_) - 1)) == 0 ? 1 : -1])), \
+    .statistics = (statistics_), \
+}
+
+/**
+ * @brief FIFO structure initialiser. Compilation will fail if the number of
+ * records is not a power of two.
+ * @param records_ Array of records.
+ */
+#define FIFO_RECORD(records_) FIFO_RECORD_WITH_STATISTICS(records_, NULL)
+
+//------------------------------------------------------------------------------
+// Inline functions
+
+/**
+ * @brief Returns the number of records available to read from the FIFO.
+ * @param fifo FIFO structure.
+ * @return Number of records available.
+ */
+static inline __attribute__((always_inline)) size_t FifoRecordAvailableRead(FifoRecord * const fifo) {
+    const size_t writeIndex = __atomic_load_n(&fifo->writeIndex, __ATOMIC_ACQUIRE);
+    return writeIndex - __atomic_load_n(&fifo->readIndex, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Returns a pointer to the oldest record. The record may be read in
+ * place and must be released using FifoRecordReadRelease.
+ * @param fifo FIFO structure.
+ * @return Pointer to the record, or NULL if no records are available.
+ */
+static inline __attribute__((always_inline)) const void* FifoRecordReadPeek(FifoRecord * const fifo) {
+    const size_t readIndex = fifo->readIndex;
+    if (__atomic_load_n(&fifo->writeIndex, __ATOMIC_ACQUIRE) == readIndex) {
+        return NULL;
+    }
+    return &fifo->data[(readIndex & fifo->mask) * fifo->recordSize];
+}
+
+/**
+ * @brief Releases the record provided by FifoRecordReadPeek so that the space
+ * may be written to.
+ * @param fifo FIFO structure.
+ */
+static inline __attribute__((always_inline)) void FifoRecordReadRelease(FifoRecord * const fifo) {
+    __atomic_store_n(&fifo->readIndex, fifo->readIndex + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Returns the number of records that may be written to the FIFO.
+ * @param fifo FIFO structure.
+ * @return Number of records.
+ */
+static inline __attribute__((always_inline)) size_t FifoRecordAvailableWrite(FifoRecord * const fifo) {
+    const size_t readIndex = __atomic_load_n(&fifo->readIndex, __ATOMIC_ACQUIRE);
+    return (fifo->mask + 1) - (__atomic_load_n(&fifo->writeIndex, __ATOMIC_RELAXED) - readIndex);
+}
+
+/**
+ * @brief Returns a pointer to the next free record. The record may be written
+ * in place and must be committed using FifoRecordWriteCommit.
+ * @param fifo FIFO structure.
+ * @return Pointer to the record, or NULL if the FIFO is full.
+ */
+static inline __attribute__((always_inline)) void* FifoRecordWriteReserve(FifoRecord * const fifo) {
+    const size_t writeIndex = fifo->writeIndex;
+    if ((writeIndex - __atomic_load_n(&fifo->readIndex, __ATOMIC_ACQUIRE)) > fifo->mask) {
+        FifoStatisticsOverflow(fifo->statistics);
+        return NULL;
+    }
+    return &fifo->data[(writeIndex & fifo->mask) * fifo->recordSize];
+}
+
+/**
+ * @brief Commits the record provided by FifoRecordWriteReserve so that it may
+ * be read.
+ * @param fifo FIFO structure.
+ */
+static inline __attribute__((always_inline)) void FifoRecordWriteCommit(FifoRecord * const fifo) {
+    __atomic_store_n(&fifo->writeIndex, fifo->writeIndex + 1, __ATOMIC_RELEASE);
+    FifoStatisticsOccupancy(fifo->statistics, fifo->writeIndex - __atomic_load_n(&fifo->readIndex, __ATOMIC_ACQUIRE));
+}
+
+/**
+ * @brief Clears the FIFO.
+ * @param fifo FIFO structure.
+ */
+static inline __attribute__((always_inline)) void FifoRecordClear(FifoRecord * const fifo) {
+    __atomic_store_n(&fifo->readIndex, __atomic_load_n(&fifo->writeIndex, __ATOMIC_ACQUIRE), __ATOMIC_RELEASE);
+}
+
+#endif
+
+//------------------------------------------------------------------------------
+// End of file
@@ -0,0 +1,76 @@
+/**
+ * @file FifoStatistics.h
+ * @author Seb Madgwick
+ * @brief FIFO statistics. Occupancy and overflows are updated by the FIFO
+ * functions of the producer if the FIFO was initialised with statistics.
+ * Latency is updated by the module that owns the FIFO.
+ */
+
+#ifndef FIFO_STATISTICS_H
+#define FIFO_STATISTICS_H
+
+//------------------------------------------------------------------------------
+// Includes
+
+#include <stddef.h>
+#include <stdint.h>
+
+//------------------------------------------------------------------------------
+// Definitions
+
+/**
+ * @brief FIFO statistics.
+ */
+typedef struct {
+    size_t maxOccupancy;
+    uint32_t numberOfOverflows;
+    uint32_t numberOfLatencySamples;
+    uint64_t totalLatencyTicks;
+    uint32_t maxLatencyTicks;
+} FifoStatistics;
+
+//------------------------------------------------------------------------------
+// Inline functions
+
+/**
+ * @brief Updates the maximum occupancy.
+ * @param statistics Statistics. May be NULL.
+ * @param occupancy Occupancy.
+ */
+static inline __attribute__((always_inline)) void FifoStatisticsOccupancy(FifoStatistics * const statistics, const size_t occupancy) {
+    if (statistics == NULL) {
+        return;
+    }
+    if (occupancy > statistics->maxOccupancy) {
+        statistics->maxOccupancy = occupancy;
+    }
+}
+
+/**
+ * @brief Increments the number of overflows.
+ * @param statistics Statistics. May be NULL.
+ */
+static inline __attribute__((always_inline)) void FifoStatisticsOverflow(FifoStatistics * const statistics) {
+    if (statistics == NULL) {
+        return;
+    }
+    statistics->numberOfOverflows++;
+}
+
+/**
+ * @brief Adds a latency sample.
+ * @param statistics Statistics.
+ * @param ticks Time in the FIFO in timer ticks.
+ */
+static inline __attribute__((always_inline)) void FifoStatisticsLatency(FifoStatistics * const statistics, const uint32_t ticks) {
+    statistics->numberOfLatencySamples++;
+    statistics->totalLatencyTicks += ticks;
+    if (ticks > statistics->maxLatencyTicks) {
+        statistics->maxLatencyTicks = ticks;
+    }
+}
+
+#endif
+
+//------------------------------------------------------------------------------
+// End of file
@@ -11,6 +11,7 @@
 // Includes
 
 #include "Fifo.h"
+#include "FifoStatistics.h"
 #include <stdbool.h>
 #include <stddef.h>
 #include "Uart.h"
@@ -28,6 +29,8 @@ FifoResult Uart1Write(const void* const data, const size_t numberOfBytes);
 FifoResult Uart1WriteByte(const uint8_t byte);
 void Uart1ClearReadBuffer(void);
 void Uart1ClearWriteBuffer(void);
+void Uart1GetReadBufferStatistics(FifoStatistics * const statistics);
+void Uart1GetWriteBufferStatistics(FifoStatistics * const statistics);
 bool Uart1ReceiveBufferOverrun(void);
 bool Uart1TransmitionComplete(void);
 
@@ -9,6 +9,7 @@
 
 #include "Config.h"
 #include "definitions.h"
+#include "FifoMasked.h"
 #include <stdint.h>
 #include "Uart2.h"
 
@@ -23,9 +24,11 @@ static inline __attribute__((always_inline)) void TxInterruptTasks(void);
 
 static bool receiveBufferOverrun;
 static uint8_t readData[UART2_READ_BUFFER_SIZE];
-static Fifo readFifo = {.data = readData, .dataSize = sizeof (readData)};
+static FifoStatistics readFifoStatistics;
+static FifoMasked readFifo = FIFO_MASKED_WITH_STATISTICS(readData, sizeof (readData), 0, &readFifoStatistics);
 static uint8_t writeData[UART2_WRITE_BUFFER_SIZE];
-static Fifo writeFifo = {.data = writeData, .dataSize = sizeof (writeData)};
+static FifoStatistics writeFifoStatistics;
+static FifoMasked writeFifo = FIFO_MASKED_WITH_STATISTICS(writeData, sizeof (writeData), 0, &writeFifoStatistics);
 
 //------------------------------------------------------------------------------
 // Functions
@@ -100,7 +103,7 @@ size_t Uart2AvailableRead(void) {
     }
 
     // Return number of bytes
-    return FifoAvailableRead(&readFifo);
+    return FifoMaskedAvailableRead(&readFifo);
 }
 
 /**
@@ -111,7 +114,7 @@ size_t Uart2AvailableRead(void) {
  */
 size_t Uart2Read(void* const destination, size_t numberOfBytes) {
     Uart2AvailableRead(); // process hardware receive buffer
-    return FifoRead(&readFifo, destination, numberOfBytes);
+    return FifoMaskedRead(&readFifo, destination, numberOfBytes);
 }
 
 /**
@@ -120,7 +123,7 @@ size_t Uart2Read(void* const destination, size_t numberOfBytes) {
  * @return Byte.
  */
 uint8_t Uart2ReadByte(void) {
-    return FifoReadByte(&readFifo);
+    return FifoMaskedReadByte(&readFifo);
 }
 
 /**
@@ -128,7 +131,7 @@ uint8_t Uart2ReadByte(void) {
  * @return Space available in the write buffer.
  */
 size_t Uart2AvailableWrite(void) {
-    return FifoAvailableWrite(&writeFifo);
+    return FifoMaskedAvailableWrite(&writeFifo);
 }
 
 /**
@@ -138,7 +141,7 @@ size_t Uart2AvailableWrite(void) {
  * @return Result.
  */
 FifoResult Uart2Write(const void* const data, const size_t numberOfBytes) {
-    const FifoResult result = FifoWrite(&writeFifo, data, numberOfBytes);
+    const FifoResult result = FifoMaskedWrite(&writeFifo, data, numberOfBytes);
     EVIC_SourceEnable(INT_SOURCE_UART2_TX);
     return result;
 }
@@ -149,7 +152,7 @@ FifoResult Uart2Write(const void* const data, const size_t numberOfBytes) {
  * @return Result.
  */
 FifoResult Uart2WriteByte(const uint8_t byte) {
-    const FifoResult result = FifoWriteByte(&writeFifo, byte);
+    const FifoResult result = FifoMaskedWriteByte(&writeFifo, byte);
     EVIC_SourceEnable(INT_SOURCE_UART2_TX);
     return result;
 }
@@ -158,7 +161,7 @@ FifoResult Uart2WriteByte(const uint8_t byte) {
  * @brief Clears the read buffer and resets the read buffer overrun flag.
  */
 void Uart2ClearReadBuffer(void) {
-    FifoClear(&readFifo);
+    FifoMaskedClear(&readFifo);
     Uart2ReceiveBufferOverrun();
 }
 
@@ -166,7 +169,31 @@ void Uart2ClearReadBuffer(void) {
  * @brief Clears the write buffer.
  */
 void Uart2ClearWriteBuffer(void) {
-    FifoClear(&writeFifo);
+    FifoMaskedClear(&writeFifo);
+}
+
+/**
+ * @brief Gets the read buffer statistics. Calling this function will reset the
+ * statistics.
+ * @param statistics Statistics.
+ */
+void Uart2GetReadBufferStatistics(FifoStatistics * const statistics) {
+    const bool interruptStatus = SYS_INT_Disable();
+    *statistics = readFifoStatistics;
+    readFifoStatistics = (FifoStatistics){0};
+    SYS_INT_Restore(interruptStatus);
+}
+
+/**
+ * @brief Gets the write buffer statistics. Calling this function will reset
+ * the statistics.
+ * @param statistics Statistics.
+ */
+void Uart2GetWriteBufferStatistics(FifoStatistics * const statistics) {
+    const bool interruptStatus = SYS_INT_Disable();
+    *statistics = writeFifoStatistics;
+    writeFifoStatistics = (FifoStatistics){0};
+    SYS_INT_Restore(interruptStatus);
 }
 
 /**
@@ -237,12 +264,11 @@ void Uart2TxInterruptHandler(void) {
  */
 static inline __attribute__((always_inline)) void RxInterruptTasks(void) {
     while (U2STAbits.URXDA == 1) { // while data available in receive buffer
-        if (FifoAvailableWrite(&readFifo) == 0) { // if read buffer full
-            EVIC_SourceDisable(INT_SOURCE_UART2_RX);
+        if ((FifoMaskedAvailableWrite(&readFifo) == 0) && (U2MODEbits.UEN == 0b10)) { // if read buffer full and RTS/CTS enabled
+            EVIC_SourceDisable(INT_SOURCE_UART2_RX); // leave data in hardware receive buffer so that RTS is deasserted
             break;
-        } else {
-            FifoWriteByte(&readFifo, U2RXREG);
         }
+        FifoMaskedWriteByte(&readFifo, U2RXREG); // byte is discarded and counted as an overflow if read buffer full
     }
     EVIC_SourceStatusClear(INT_SOURCE_UART2_RX);
 }
@@ -254,10 +280,10 @@ static inline __attribute__((always_inline)) void TxInterruptTasks(void) {
     EVIC_SourceDisable(INT_SOURCE_UART2_TX); // disable TX interrupt to avoid nested interrupt
     EVIC_SourceStatusClear(INT_SOURCE_UART2_TX);
     while (U2STAbits.UTXBF == 0) { // while transmit buffer not full
-        if (FifoAvailableRead(&writeFifo) == 0) { // if write buffer empty
+        if (FifoMaskedAvailableRead(&writeFifo) == 0) { // if write buffer empty
             return;
         }
-        U2TXREG = FifoReadByte(&writeFifo);
+        U2TXREG = FifoMaskedReadByte(&writeFifo);
     }
     EVIC_SourceEnable(INT_SOURCE_UART2_TX); // re-enable TX interrupt
 }
@@ -11,6 +11,7 @@
 // Includes
 
 #include "Fifo.h"
+#include "FifoStatistics.h"
 #include <stdbool.h>
 #include <stddef.h>
 #include "Uart.h"
@@ -28,6 +29,8 @@ FifoResult Uart2Write(const void* const data, const size_t numberOfBytes);
 FifoResult Uart2WriteByte(const uint8_t byte);
 void Uart2ClearReadBuffer(void);
 void Uart2ClearWriteBuffer(void);
+void Uart2GetReadBufferStatistics(FifoStatistics * const statistics);
+void Uart2GetWriteBufferStatistics(FifoStatistics * const statistics);
 bool Uart2ReceiveBufferOverrun(void);
 bool Uart2TransmitionComplete(void);
 
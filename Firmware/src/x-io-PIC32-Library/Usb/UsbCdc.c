@@ -9,29 +9,107 @@
 
 #include "Config.h"
 #include "definitions.h"
+#include "FifoMasked.h"
+#include "Timer/Timer.h"
 #include "UsbCdc.h"
 
+//------------------------------------------------------------------------------
+// Definitions
+
+/**
+ * @brief Transfer sizes must be a multiple of the high-speed bulk packet size.
+ */
+#if ((USB_CDC_READ_TRANSFER_SIZE % USB_CDC_PACKET_SIZE) != 0) || ((USB_CDC_WRITE_TRANSFER_SIZE % USB_CDC_PACKET_SIZE) != 0)
+#error "Transfer size must be a multiple of the packet size."
+#endif
+
+/**
+ * @brief Read buffer must have space for every read transfer in progress.
+ */
+#if USB_CDC_READ_BUFFER_SIZE < (USB_CDC_READ_TRANSFERS * USB_CDC_READ_TRANSFER_SIZE)
+#error "Read buffer size must not be less than the total size of the read transfers."
+#endif
+
+/**
+ * @brief Alignment of the data of each write transfer required by the USB DMA.
+ */
+#define WRITE_ALIGNMENT (sizeof (uint32_t))
+
+/**
+ * @brief Write reserve must keep the space reserved a multiple of the
+ * alignment.
+ */
+#if (USB_CDC_WRITE_RESERVE_SIZE % 4) != 0
+#error "Write reserve size must be a multiple of 4."
+#endif
+
+/**
+ * @brief CDC port. Each write queue is written to a separate CDC port. Data
+ * is written in place from the write queue and released once the transfer is
+ * complete. The latency of one byte at a time is sampled from when it is
+ * written to the queue until it is released. The time that data is written to
+ * an empty queue is recorded so that gaps are only measured while data is
+ * pending.
+ */
+typedef struct {
+    const USB_DEVICE_CDC_INDEX index;
+    FifoMasked * const writeFifo;
+    FifoStatistics * const writeFifoStatistics;
+    USB_CDC_LINE_CODING lineCoding;
+    volatile bool open;
+    volatile uint32_t writesScheduled;
+    volatile uint32_t writesCompleted;
+    volatile size_t writeTransferSizes[USB_CDC_WRITE_TRANSFERS];
+    volatile uint32_t idleTicks;
+    uint32_t pendingTicks;
+    uint32_t bytesAcquired;
+    uint32_t bytesWritten;
+    uint32_t bytesReleased;
+    bool latencySamplePending;
+    uint32_t latencySampleBytes;
+    uint32_t latencySampleTicks;
+} Port;
+
 //------------------------------------------------------------------------------
 // Function declarations
 
 static void APP_USBDeviceEventHandler(USB_DEVICE_EVENT event, void * eventData, uintptr_t context);
 static void APP_USBDeviceCDCEventHandler(USB_DEVICE_CDC_INDEX instanceIndex, USB_DEVICE_CDC_EVENT event, void* pData, uintptr_t context);
 static void ReadTasks(void);
-static void WriteTasks(void);
+static void ReadComplete(const USB_DEVICE_CDC_EVENT_DATA_READ_COMPLETE * const readComplete);
+static void WriteTasks(Port * const port);
+static void WriteComplete(Port * const port);
+static void WriteLatencyStart(Port * const port, const size_t numberOfBytes);
+static void Disconnected(void);
+static void StartOfFrame(const uint32_t ticks, const uint16_t frameNumber);
+static void StartOfFrameInterruptEnable(void);
 
 //------------------------------------------------------------------------------
 // Variables
 
 static volatile USB_DEVICE_HANDLE usbDeviceHandle = USB_DEVICE_HANDLE_INVALID;
 static volatile bool hostConnected;
-static volatile bool portOpen;
-static volatile uint8_t __attribute__((coherent)) readRequestData[512]; // must be declared __attribute__((coherent)) for PIC32MZ devices
-static volatile bool readInProgress;
-static volatile bool writeInProgress;
+static volatile uint8_t __attribute__((coherent)) readRequestData[USB_CDC_READ_TRANSFERS][USB_CDC_READ_TRANSFER_SIZE]; // must be declared __attribute__((coherent)) for PIC32MZ devices
+static volatile uint32_t readsScheduled;
+static volatile uint32_t readsCompleted;
+static UsbCdcWriteStatistics writeStatistics;
+static volatile UsbCdcStartOfFrame startOfFrame;
+static volatile uint32_t startOfFrameCount;
+static bool startOfFrameEnabled;
 static uint8_t readData[USB_CDC_READ_BUFFER_SIZE];
-static Fifo readFifo = {.data = readData, .dataSize = sizeof (readData)};
-static uint8_t writeData[USB_CDC_WRITE_BUFFER_SIZE];
-static Fifo writeFifo = {.data = writeData, .dataSize = sizeof (writeData)};
+static FifoStatistics readFifoStatistics;
+static FifoMasked readFifo = FIFO_MASKED_WITH_STATISTICS(readData, sizeof (readData), 0, &readFifoStatistics);
+static uint8_t __attribute__((coherent, aligned(16))) priorityWriteData[USB_CDC_PRIORITY_WRITE_BUFFER_SIZE + USB_CDC_WRITE_RESERVE_SIZE]; // must be declared __attribute__((coherent)) for PIC32MZ devices
+static uint8_t __attribute__((coherent, aligned(16))) bulkWriteData[USB_CDC_WRITE_BUFFER_SIZE + USB_CDC_WRITE_RESERVE_SIZE]; // must be declared __attribute__((coherent)) for PIC32MZ devices
+static FifoStatistics writeFifoStatistics[2];
+static FifoMasked writeFifos[] = {
+    [UsbCdcQueuePriority] = FIFO_MASKED_WITH_STATISTICS(priorityWriteData, USB_CDC_PRIORITY_WRITE_BUFFER_SIZE, USB_CDC_WRITE_RESERVE_SIZE, &writeFifoStatistics[UsbCdcQueuePriority]),
+    [UsbCdcQueueBulk] = FIFO_MASKED_WITH_STATISTICS(bulkWriteData, USB_CDC_WRITE_BUFFER_SIZE, USB_CDC_WRITE_RESERVE_SIZE, &writeFifoStatistics[UsbCdcQueueBulk]),
+};
+static Port ports[] = {
+    [UsbCdcQueuePriority] = {.index = USB_DEVICE_CDC_INDEX_0, .writeFifo = &writeFifos[UsbCdcQueuePriority], .writeFifoStatistics = &writeFifoStatistics[UsbCdcQueuePriority], .lineCoding = {.bDataBits = 8, .dwDTERate = 115000}},
+    [UsbCdcQueueBulk] = {.index = USB_DEVICE_CDC_INDEX_1, .writeFifo = &writeFifos[UsbCdcQueueBulk], .writeFifoStatistics = &writeFifoStatistics[UsbCdcQueueBulk], .lineCoding = {.bDataBits = 8, .dwDTERate = 115000}},
+};
 
 //------------------------------------------------------------------------------
 // Functions
@@ -47,13 +125,15 @@ void UsbCdcTasks(void) {
         usbDeviceHandle = USB_DEVICE_Open(USB_DEVICE_INDEX_0, DRV_IO_INTENT_READWRITE);
         if (usbDeviceHandle != USB_DEVICE_HANDLE_INVALID) {
             USB_DEVICE_EventHandlerSet(usbDeviceHandle, APP_USBDeviceEventHandler, 0);
+            StartOfFrameInterruptEnable();
         }
     }
 
     // CDC read/write tasks
     if (hostConnected) {
         ReadTasks();
-        WriteTasks();
+        WriteTasks(&ports[UsbCdcQueuePriority]);
+        WriteTasks(&ports[UsbCdcQueueBulk]);
     }
 }
 
@@ -65,120 +145,240 @@ static void APP_USBDeviceEventHandler(USB_DEVICE_EVENT event, void * eventData,
         case USB_DEVICE_EVENT_RESET:
         case USB_DEVICE_EVENT_SUSPENDED:
         case USB_DEVICE_EVENT_DECONFIGURED:
-            hostConnected = false;
-            portOpen = false;
-            readInProgress = false;
-            writeInProgress = false;
+            Disconnected();
             break;
         case USB_DEVICE_EVENT_CONFIGURED:
             if (((USB_DEVICE_EVENT_DATA_CONFIGURED *) eventData)->configurationValue == 1) {
-                USB_DEVICE_CDC_EventHandlerSet(USB_DEVICE_CDC_INDEX_0, APP_USBDeviceCDCEventHandler, (uintptr_t) NULL);
+                USB_DEVICE_CDC_EventHandlerSet(USB_DEVICE_CDC_INDEX_0, APP_USBDeviceCDCEventHandler, (uintptr_t) & ports[UsbCdcQueuePriority]);
+                USB_DEVICE_CDC_EventHandlerSet(USB_DEVICE_CDC_INDEX_1, APP_USBDeviceCDCEventHandler, (uintptr_t) & ports[UsbCdcQueueBulk]);
+                ports[UsbCdcQueuePriority].idleTicks = TimerGetTicks32();
+                ports[UsbCdcQueueBulk].idleTicks = TimerGetTicks32();
                 hostConnected = true;
+                USB_CDC_EVENT();
             }
             break;
         case USB_DEVICE_EVENT_POWER_DETECTED:
             USB_DEVICE_Attach(usbDeviceHandle);
+            USB_CDC_EVENT();
             break;
         case USB_DEVICE_EVENT_POWER_REMOVED:
             USB_DEVICE_Detach(usbDeviceHandle);
-            hostConnected = false;
-            portOpen = false;
-            readInProgress = false;
-            writeInProgress = false;
+            Disconnected();
+            break;
+        case USB_DEVICE_EVENT_SOF:
+            StartOfFrame(TimerGetTicks32(), ((USB_DEVICE_EVENT_DATA_SOF *) eventData)->frameNumber);
             break;
         default:
             break;
     }
 }
 
+/**
+ * @brief Resets state when the host is disconnected. Write transfers in
+ * progress are released.
+ */
+static void Disconnected(void) {
+    hostConnected = false;
+    readsCompleted = readsScheduled;
+    for (int index = 0; index < (int) (sizeof (ports) / sizeof (Port)); index++) {
+        Port * const port = &ports[index];
+        port->open = false;
+        while (port->writesCompleted != port->writesScheduled) {
+            WriteComplete(port);
+        }
+    }
+    USB_CDC_EVENT();
+}
+
+/**
+ * @brief Captures the timer on the first start of frame of each frame. The
+ * capture count is incremented after the capture so that it may be read
+ * consistently outside of the interrupt. No event is signalled so that the
+ * main program loop is not woken every frame. The capture is read on the next
+ * tick.
+ * @param ticks Timer ticks.
+ * @param frameNumber Frame number.
+ */
+static void StartOfFrame(const uint32_t ticks, const uint16_t frameNumber) {
+    static uint16_t previousFrameNumber = UINT16_MAX;
+    if (frameNumber == previousFrameNumber) {
+        return;
+    }
+    previousFrameNumber = frameNumber;
+    startOfFrame.ticks = ticks;
+    startOfFrame.frameNumber = frameNumber;
+    startOfFrameCount++;
+}
+
+/**
+ * @brief Writes the start of frame interrupt enable. The USB driver enables
+ * the interrupt on initialisation.
+ */
+static void StartOfFrameInterruptEnable(void) {
+    ((usbhs_registers_t *) USBHS_ID_0)->INTRUSBEbits.SOFIE = startOfFrameEnabled ? 1 : 0;
+}
+
 /**
  * @brief USB device CDC event handler based on MPLAB Harmony examples.
  */
 static void APP_USBDeviceCDCEventHandler(USB_DEVICE_CDC_INDEX index, USB_DEVICE_CDC_EVENT event, void * pData, uintptr_t userData) {
-    static USB_CDC_LINE_CODING usbCdcLineCoding = {
-        .bDataBits = 8,
-        .dwDTERate = 115000,
-        .bCharFormat = 0,
-        .bParityType = 0
-    };
+    Port * const port = (Port *) userData;
     switch (event) {
         case USB_DEVICE_CDC_EVENT_GET_LINE_CODING:
-            USB_DEVICE_ControlSend(usbDeviceHandle, (uint8_t *) & usbCdcLineCoding, sizeof (usbCdcLineCoding));
+            USB_DEVICE_ControlSend(usbDeviceHandle, (uint8_t *) & port->lineCoding, sizeof (port->lineCoding));
             break;
         case USB_DEVICE_CDC_EVENT_SET_LINE_CODING:
-            USB_DEVICE_ControlReceive(usbDeviceHandle, (uint8_t *) & usbCdcLineCoding, sizeof (usbCdcLineCoding));
+            USB_DEVICE_ControlReceive(usbDeviceHandle, (uint8_t *) & port->lineCoding, sizeof (port->lineCoding));
             break;
         case USB_DEVICE_CDC_EVENT_SET_CONTROL_LINE_STATE:
-            portOpen = ((USB_CDC_CONTROL_LINE_STATE *) pData)->dtr == 1;
+            port->open = ((USB_CDC_CONTROL_LINE_STATE *) pData)->dtr == 1;
             USB_DEVICE_ControlStatus(usbDeviceHandle, USB_DEVICE_CONTROL_STATUS_OK);
             break;
         case USB_DEVICE_CDC_EVENT_SEND_BREAK:
             USB_DEVICE_ControlStatus(usbDeviceHandle, USB_DEVICE_CONTROL_STATUS_OK);
             break;
         case USB_DEVICE_CDC_EVENT_READ_COMPLETE:
-            if (readInProgress) { // prevent unexpected read event for PIC32MZ devices when host reconnected
-                const size_t numberOfBytes = ((USB_DEVICE_CDC_EVENT_DATA_READ_COMPLETE*) pData)->length;
-                FifoWrite(&readFifo, (void*) readRequestData, numberOfBytes);
-                readInProgress = false;
-            }
+            ReadComplete((USB_DEVICE_CDC_EVENT_DATA_READ_COMPLETE*) pData);
             break;
         case USB_DEVICE_CDC_EVENT_CONTROL_TRANSFER_DATA_RECEIVED:
             USB_DEVICE_ControlStatus(usbDeviceHandle, USB_DEVICE_CONTROL_STATUS_OK);
             break;
         case USB_DEVICE_CDC_EVENT_WRITE_COMPLETE:
-            writeInProgress = false;
+            WriteComplete(port);
             break;
         default:
             break;
     }
+    USB_CDC_EVENT();
 }
 
 /**
- * @brief Read tasks.
+ * @brief Read tasks. Data is only read from the port of the priority queue. Up
+ * to USB_CDC_READ_TRANSFERS transfers are kept in progress so that the
+ * endpoint can receive while a completed transfer is processed. A transfer is
+ * only scheduled if the read buffer has space for the maximum size of every
+ * transfer in progress. Otherwise, the endpoint NAKs the host until the
+ * application reads from the buffer, and no data is discarded.
  */
 static void ReadTasks(void) {
+    while ((readsScheduled - readsCompleted) < USB_CDC_READ_TRANSFERS) {
 
-    // Do nothing if read in progress
-    if (readInProgress) {
-        return;
+        // Do nothing if not enough space available
+        const uint32_t readsInProgress = readsScheduled - readsCompleted;
+        if (FifoMaskedAvailableWrite(&readFifo) < ((readsInProgress + 1) * USB_CDC_READ_TRANSFER_SIZE)) {
+            return;
+        }
+
+        // Schedule read
+        const uint32_t index = readsScheduled % USB_CDC_READ_TRANSFERS;
+        readsScheduled++; // increment before read because read may complete before function returns
+        USB_DEVICE_CDC_TRANSFER_HANDLE usbDeviceCdcTransferHandle = USB_DEVICE_CDC_TRANSFER_HANDLE_INVALID;
+        const USB_DEVICE_CDC_RESULT usbDeviceCdcResult = USB_DEVICE_CDC_Read(USB_DEVICE_CDC_INDEX_0, &usbDeviceCdcTransferHandle, (void*) readRequestData[index], USB_CDC_READ_TRANSFER_SIZE);
+        if (usbDeviceCdcResult != USB_DEVICE_CDC_RESULT_OK) {
+            readsScheduled--;
+            return;
+        }
     }
+}
 
-    // Schedule read
-    readInProgress = true;
-    static USB_DEVICE_CDC_TRANSFER_HANDLE usbDeviceCdcTransferHandle = USB_DEVICE_CDC_TRANSFER_HANDLE_INVALID;
-    const USB_DEVICE_CDC_RESULT usbDeviceCdcResult = USB_DEVICE_CDC_Read(USB_DEVICE_CDC_INDEX_0, &usbDeviceCdcTransferHandle, (void*) readRequestData, sizeof (readRequestData));
-    if (usbDeviceCdcResult != USB_DEVICE_CDC_RESULT_OK) {
-        readInProgress = false;
-        return;
+/**
+ * @brief Writes the data of the oldest read transfer in progress to the read
+ * buffer. Transfers complete in the order that they were scheduled. Space for
+ * the data was ensured when the transfer was scheduled. The data of a transfer
+ * that did not complete successfully, such as a transfer aborted by a reset, is
+ * discarded.
+ * @param readComplete Read complete event data.
+ */
+static void ReadComplete(const USB_DEVICE_CDC_EVENT_DATA_READ_COMPLETE * const readComplete) {
+    if (readsCompleted == readsScheduled) {
+        return; // prevent unexpected read event for PIC32MZ devices when host reconnected
     }
+    if (readComplete->status == USB_DEVICE_CDC_RESULT_OK) {
+        FifoMaskedWrite(&readFifo, (void*) readRequestData[readsCompleted % USB_CDC_READ_TRANSFERS], readComplete->length);
+    }
+    readsCompleted++;
 }
 
 /**
- * @brief Write tasks.
+ * @brief Write tasks. Up to USB_CDC_WRITE_TRANSFERS transfers are kept in
+ * progress so that the endpoint is not idle between the completion of one
+ * transfer and the scheduling of the next. Each transfer is written in place
+ * from a contiguous span of the write queue, so a span that wraps around is
+ * written as two transfers. A transfer that ends on a packet boundary is
+ * followed by a zero-length packet unless more data follows immediately. The
+ * USB DMA requires a word-aligned source. Every span starts on a word boundary
+ * because each write to the queue is padded to a multiple of WRITE_ALIGNMENT
+ * and the wraparound point and transfer size are multiples of it.
+ * @param port Port.
  */
-static void WriteTasks(void) {
+static void WriteTasks(Port * const port) {
+    while ((port->writesScheduled - port->writesCompleted) < USB_CDC_WRITE_TRANSFERS) {
 
-    // Do nothing if write in progress
-    if (writeInProgress) {
-        return;
-    }
+        // Do nothing if no data available
+        size_t numberOfBytes;
+        const void* const data = FifoMaskedReadPeek(port->writeFifo, &numberOfBytes);
+        if (numberOfBytes == 0) {
+            return;
+        }
 
-    // Do nothing if no data available
-    if (FifoAvailableRead(&writeFifo) == 0) {
-        return;
+        // Limit transfer size
+        USB_DEVICE_CDC_TRANSFER_FLAGS flags = USB_DEVICE_CDC_TRANSFER_FLAGS_DATA_COMPLETE;
+        if (numberOfBytes > USB_CDC_WRITE_TRANSFER_SIZE) {
+            numberOfBytes = USB_CDC_WRITE_TRANSFER_SIZE;
+            flags = USB_DEVICE_CDC_TRANSFER_FLAGS_MORE_DATA_PENDING; // more data follows so zero-length packet not required
+        }
+
+        // Schedule write
+        const bool idle = port->writesScheduled == port->writesCompleted;
+        port->writeTransferSizes[port->writesScheduled % USB_CDC_WRITE_TRANSFERS] = numberOfBytes;
+        port->writesScheduled++; // increment before write because write may complete before function returns
+        USB_DEVICE_CDC_TRANSFER_HANDLE usbDeviceCdcTransferHandle = USB_DEVICE_CDC_TRANSFER_HANDLE_INVALID;
+        const USB_DEVICE_CDC_RESULT usbDeviceCdcResult = USB_DEVICE_CDC_Write(port->index, &usbDeviceCdcTransferHandle, data, numberOfBytes, flags);
+        if (usbDeviceCdcResult != USB_DEVICE_CDC_RESULT_OK) {
+            port->writesScheduled--;
+            writeStatistics.numberOfErrors++;
+            return;
+        }
+        FifoMaskedReadAcquire(port->writeFifo, numberOfBytes);
+        __atomic_store_n(&port->bytesAcquired, port->bytesAcquired + numberOfBytes, __ATOMIC_RELEASE);
+
+        // Update statistics
+        if (idle) {
+            const uint32_t pendingTicks = __atomic_load_n(&port->pendingTicks, __ATOMIC_ACQUIRE);
+            const uint32_t gapStartTicks = (int32_t) (pendingTicks - port->idleTicks) > 0 ? pendingTicks : port->idleTicks; // later of endpoint idle and data pending
+            const uint32_t gap = TimerGetTicks32() - gapStartTicks;
+            writeStatistics.numberOfGaps++;
+            writeStatistics.totalGapTicks += gap;
+            if (gap > writeStatistics.maxGapTicks) {
+                writeStatistics.maxGapTicks = gap;
+            }
+        }
+        writeStatistics.numberOfTransfers++;
+        writeStatistics.numberOfBytes += numberOfBytes;
     }
+}
 
-    // Copy data to buffer
-    static uint8_t __attribute__((coherent)) buffer[1024]; // must be declared __attribute__((coherent)) for PIC32MZ devices
-    const size_t numberOfBytes = FifoRead(&writeFifo, buffer, sizeof (buffer));
+/**
+ * @brief Releases the data of the oldest write transfer in progress. Transfers
+ * complete in the order that they were scheduled.
+ * @param port Port.
+ */
+static void WriteComplete(Port * const port) {
+    if (port->writesCompleted == port->writesScheduled) {
+        return; // ignore unexpected event
+    }
+    const size_t numberOfBytes = port->writeTransferSizes[port->writesCompleted % USB_CDC_WRITE_TRANSFERS];
+    FifoMaskedReadRelease(port->writeFifo, numberOfBytes);
+    port->writesCompleted++;
 
-    // Schedule write
-    writeInProgress = true;
-    static USB_DEVICE_CDC_TRANSFER_HANDLE usbDeviceCdcTransferHandle = USB_DEVICE_CDC_TRANSFER_HANDLE_INVALID;
-    const USB_DEVICE_CDC_RESULT usbDeviceCdcResult = USB_DEVICE_CDC_Write(USB_DEVICE_CDC_INDEX_0, &usbDeviceCdcTransferHandle, buffer, numberOfBytes, USB_DEVICE_CDC_TRANSFER_FLAGS_DATA_COMPLETE);
-    if (usbDeviceCdcResult != USB_DEVICE_CDC_RESULT_OK) {
-        writeInProgress = false;
-        return;
+    // Complete latency sample
+    port->bytesReleased += numberOfBytes;
+    if (__atomic_load_n(&port->latencySamplePending, __ATOMIC_ACQUIRE) && ((int32_t) (port->bytesReleased - port->latencySampleBytes) >= 0)) {
+        FifoStatisticsLatency(port->writeFifoStatistics, TimerGetTicks32() - port->latencySampleTicks);
+        __atomic_store_n(&port->latencySamplePending, false, __ATOMIC_RELEASE);
+    }
+    if (port->writesCompleted == port->writesScheduled) {
+        port->idleTicks = TimerGetTicks32();
     }
 }
 
@@ -191,11 +391,12 @@ bool UsbCdcHostConnected(void) {
 }
 
 /**
- * @brief Returns true if the port is open.
+ * @brief Returns true if the port of the write queue is open.
+ * @param queue Queue.
  * @return True if the port is open.
  */
-bool UsbCdcPortOpen(void) {
-    return portOpen;
+bool UsbCdcPortOpen(const UsbCdcQueue queue) {
+    return ports[queue].open;
 }
 
 /**
@@ -203,7 +404,7 @@ bool UsbCdcPortOpen(void) {
  * @return Number of bytes available in the read buffer.
  */
 size_t UsbCdcAvailableRead(void) {
-    return FifoAvailableRead(&readFifo);
+    return FifoMaskedAvailableRead(&readFifo);
 }
 
 /**
@@ -213,7 +414,7 @@ size_t UsbCdcAvailableRead(void) {
  * @return Number of bytes read.
  */
 size_t UsbCdcRead(void* const destination, size_t numberOfBytes) {
-    return FifoRead(&readFifo, destination, numberOfBytes);
+    return FifoMaskedRead(&readFifo, destination, numberOfBytes);
 }
 
 /**
@@ -222,34 +423,161 @@ size_t UsbCdcRead(void* const destination, size_t numberOfBytes) {
  * @return Byte.
  */
 uint8_t UsbCdcReadByte(void) {
-    return FifoReadByte(&readFifo);
+    return FifoMaskedReadByte(&readFifo);
 }
 
 /**
- * @brief Returns the space available in the write buffer.
- * @return Space available in the write buffer.
+ * @brief Returns the space available in the write queue.
+ * @param queue Queue.
+ * @return Space available in the write queue.
  */
-size_t UsbCdcAvailableWrite(void) {
-    return FifoAvailableWrite(&writeFifo);
+size_t UsbCdcAvailableWrite(const UsbCdcQueue queue) {
+    return FifoMaskedAvailableWrite(&writeFifos[queue]);
 }
 
 /**
- * @brief Writes data to the write buffer.
+ * @brief Writes data to the write queue. The data is written to contiguous
+ * space, so data larger than USB_CDC_WRITE_RESERVE_SIZE may not fit near the
+ * wraparound point.
+ * @param queue Queue.
  * @param data Data.
  * @param numberOfBytes Number of bytes.
  * @return Result.
  */
-FifoResult UsbCdcWrite(const void* const data, const size_t numberOfBytes) {
-    return FifoWrite(&writeFifo, data, numberOfBytes);
+FifoResult UsbCdcWrite(const UsbCdcQueue queue, const void* const data, const size_t numberOfBytes) {
+    USB_CDC_EVENT();
+    size_t space;
+    void* const destination = FifoMaskedWriteReserve(&writeFifos[queue], &space);
+    if (numberOfBytes > space) {
+        FifoStatisticsOverflow(ports[queue].writeFifoStatistics);
+        return FifoResultError;
+    }
+    memcpy(destination, data, numberOfBytes);
+    UsbCdcWriteCommit(queue, numberOfBytes);
+    return FifoResultOk;
+}
+
+/**
+ * @brief Returns a pointer to contiguous space in the write queue that may be
+ * written to directly and committed using UsbCdcWriteCommit.
+ * @param queue Queue.
+ * @param numberOfBytes Number of contiguous bytes available.
+ * @return Pointer to space.
+ */
+void* UsbCdcWriteReserve(const UsbCdcQueue queue, size_t * const numberOfBytes) {
+    return FifoMaskedWriteReserve(&writeFifos[queue], numberOfBytes);
 }
 
 /**
- * @brief Writes a byte to the write buffer.
- * @param byte Byte.
- * @return Result.
+ * @brief Commits data written to space provided by UsbCdcWriteReserve. The
+ * data is padded with USB_CDC_WRITE_PADDING to a multiple of WRITE_ALIGNMENT
+ * so that the next transfer starts on a word boundary. The write index and
+ * the space available are always multiples of WRITE_ALIGNMENT, so the padding
+ * always fits within the space reserved.
+ * @param queue Queue.
+ * @param numberOfBytes Number of bytes.
+ */
+void UsbCdcWriteCommit(const UsbCdcQueue queue, const size_t numberOfBytes) {
+    size_t space;
+    uint8_t * const destination = FifoMaskedWriteReserve(&writeFifos[queue], &space);
+    const size_t alignedNumberOfBytes = (numberOfBytes + (WRITE_ALIGNMENT - 1)) & ~(WRITE_ALIGNMENT - 1);
+    memset(&destination[numberOfBytes], USB_CDC_WRITE_PADDING, alignedNumberOfBytes - numberOfBytes);
+    FifoMaskedWriteCommit(&writeFifos[queue], alignedNumberOfBytes);
+    WriteLatencyStart(&ports[queue], alignedNumberOfBytes);
+    USB_CDC_EVENT();
+}
+
+/**
+ * @brief Counts the bytes written to the write queue and starts a latency
+ * sample if none is in progress. The sample is of the last byte written and
+ * completes when the byte is released. The time is recorded if no data was
+ * pending.
+ * @param port Port.
+ * @param numberOfBytes Number of bytes.
+ */
+static void WriteLatencyStart(Port * const port, const size_t numberOfBytes) {
+    if (port->bytesWritten == __atomic_load_n(&port->bytesAcquired, __ATOMIC_ACQUIRE)) {
+        __atomic_store_n(&port->pendingTicks, TimerGetTicks32(), __ATOMIC_RELEASE);
+    }
+    port->bytesWritten += numberOfBytes;
+    if (__atomic_load_n(&port->latencySamplePending, __ATOMIC_ACQUIRE)) {
+        return;
+    }
+    port->latencySampleBytes = port->bytesWritten;
+    port->latencySampleTicks = TimerGetTicks32();
+    __atomic_store_n(&port->latencySamplePending, true, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Gets the read buffer statistics. Calling this function will reset the
+ * statistics.
+ * @param statistics Statistics.
+ */
+void UsbCdcGetReadBufferStatistics(FifoStatistics * const statistics) {
+    const bool interruptStatus = SYS_INT_Disable();
+    *statistics = readFifoStatistics;
+    readFifoStatistics = (FifoStatistics){0};
+    SYS_INT_Restore(interruptStatus);
+}
+
+/**
+ * @brief Gets the write queue statistics. Latency is sampled from when data is
+ * written to the queue until the transfer is complete. Calling this function
+ * will reset the statistics.
+ * @param queue Queue.
+ * @param statistics Statistics.
+ */
+void UsbCdcGetWriteQueueStatistics(const UsbCdcQueue queue, FifoStatistics * const statistics) {
+    const bool interruptStatus = SYS_INT_Disable();
+    *statistics = writeFifoStatistics[queue];
+    writeFifoStatistics[queue] = (FifoStatistics){0};
+    SYS_INT_Restore(interruptStatus);
+}
+
+/**
+ * @brief Gets the write statistics accumulated since the previous call.
+ * Calling this function will reset the statistics.
+ * @param writeStatistics_ Write statistics.
+ */
+void UsbCdcGetWriteStatistics(UsbCdcWriteStatistics * const writeStatistics_) {
+    const bool interruptStatus = SYS_INT_Disable();
+    *writeStatistics_ = writeStatistics;
+    writeStatistics = (UsbCdcWriteStatistics){0};
+    SYS_INT_Restore(interruptStatus);
+}
+
+/**
+ * @brief Enables or disables the start of frame capture. The capture is
+ * disabled by default because the start of frame interrupt would otherwise
+ * interrupt the CPU every microframe.
+ * @param enabled True to enable.
  */
-FifoResult UsbCdcWriteByte(const uint8_t byte) {
-    return FifoWriteByte(&writeFifo, byte);
+void UsbCdcSetStartOfFrameEnabled(const bool enabled) {
+    startOfFrameEnabled = enabled;
+    if (usbDeviceHandle != USB_DEVICE_HANDLE_INVALID) {
+        StartOfFrameInterruptEnable();
+    }
+}
+
+/**
+ * @brief Gets the most recent start of frame.
+ * @param startOfFrame_ Start of frame.
+ * @return True if the start of frame has been captured since the previous
+ * call to this function.
+ */
+bool UsbCdcGetStartOfFrame(UsbCdcStartOfFrame * const startOfFrame_) {
+    static uint32_t previousCount;
+    uint32_t count;
+    do {
+        count = startOfFrameCount;
+        startOfFrame_->ticks = startOfFrame.ticks;
+        startOfFrame_->frameNumber = startOfFrame.frameNumber;
+    } while (count != startOfFrameCount); // avoid asynchronous hazard
+    if (count == previousCount) {
+        return false;
+    }
+    previousCount = count;
+    return true;
 }
 
 //------------------------------------------------------------------------------
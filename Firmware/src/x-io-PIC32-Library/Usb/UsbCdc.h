@@ -10,23 +10,86 @@
 //------------------------------------------------------------------------------
 // Includes
 
+#include "Config.h"
 #include "Fifo.h"
+#include "FifoStatistics.h"
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
+//------------------------------------------------------------------------------
+// Definitions
+
+/**
+ * @brief Called when the main program loop should call UsbCdcTasks, such as on
+ * the completion of a transfer. May be defined in Config.h to signal an event.
+ */
+#ifndef USB_CDC_EVENT
+#define USB_CDC_EVENT()
+#endif
+
+/**
+ * @brief Byte written after the data of each write to the write queue so that
+ * the next write starts on a word boundary, as required by the USB DMA. The
+ * default line termination is received by the host as empty messages. May be
+ * defined in Config.h.
+ */
+#ifndef USB_CDC_WRITE_PADDING
+#define USB_CDC_WRITE_PADDING ('\n')
+#endif
+
+/**
+ * @brief Write queue. The priority queue is written to the first CDC port,
+ * used for commands and events. The bulk queue is written to the second CDC
+ * port, used for streaming.
+ */
+typedef enum {
+    UsbCdcQueuePriority,
+    UsbCdcQueueBulk,
+} UsbCdcQueue;
+
+/**
+ * @brief Write statistics of all ports. A gap is the time between the later of
+ * the completion of the last transfer in progress and data being written to
+ * the empty write queue, and the scheduling of the next transfer on the same
+ * port.
+ */
+typedef struct {
+    uint32_t numberOfTransfers;
+    uint32_t numberOfBytes;
+    uint32_t numberOfErrors;
+    uint32_t numberOfGaps;
+    uint64_t totalGapTicks;
+    uint32_t maxGapTicks;
+} UsbCdcWriteStatistics;
+
+/**
+ * @brief Start of frame. The timer is captured on the first start of frame of
+ * each frame. High-speed microframes 1 to 7 are ignored.
+ */
+typedef struct {
+    uint32_t ticks;
+    uint16_t frameNumber;
+} UsbCdcStartOfFrame;
+
 //------------------------------------------------------------------------------
 // Function declarations
 
 void UsbCdcTasks(void);
 bool UsbCdcHostConnected(void);
-bool UsbCdcPortOpen(void);
+bool UsbCdcPortOpen(const UsbCdcQueue queue);
 size_t UsbCdcAvailableRead(void);
 size_t UsbCdcRead(void* const destination, size_t numberOfBytes);
 uint8_t UsbCdcReadByte(void);
-size_t UsbCdcAvailableWrite(void);
-FifoResult UsbCdcWrite(const void* const data, const size_t numberOfBytes);
-FifoResult UsbCdcWriteByte(const uint8_t byte);
+size_t UsbCdcAvailableWrite(const UsbCdcQueue queue);
+FifoResult UsbCdcWrite(const UsbCdcQueue queue, const void* const data, const size_t numberOfBytes);
+void* UsbCdcWriteReserve(const UsbCdcQueue queue, size_t * const numberOfBytes);
+void UsbCdcWriteCommit(const UsbCdcQueue queue, const size_t numberOfBytes);
+void UsbCdcGetWriteStatistics(UsbCdcWriteStatistics * const writeStatistics_);
+void UsbCdcSetStartOfFrameEnabled(const bool enabled);
+bool UsbCdcGetStartOfFrame(UsbCdcStartOfFrame * const startOfFrame_);
+void UsbCdcGetReadBufferStatistics(FifoStatistics * const statistics);
+void UsbCdcGetWriteQueueStatistics(const UsbCdcQueue queue, FifoStatistics * const statistics);
 
 #endif
 
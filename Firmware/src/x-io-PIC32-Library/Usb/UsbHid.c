@@ -0,0 +1,275 @@
+/**
+ * @file UsbHid.c
+ * @author Seb Madgwick
+ * @brief Vendor-defined USB HID function driver using MPLAB Harmony. Input
+ * reports are written to an interrupt IN endpoint so that the host polls for
+ * each report at the endpoint interval instead of buffering it with the CDC
+ * serial data. The Harmony HID function driver is not used. The function is
+ * registered as USB_HID_FUNCTION_DRIVER in the function registration table of
+ * usb_device_init_data.c, which also contains the interface descriptors.
+ */
+
+//------------------------------------------------------------------------------
+// Includes
+
+#include "Config.h"
+#include "definitions.h"
+#include "FifoMasked.h"
+#include "UsbHid.h"
+
+//------------------------------------------------------------------------------
+// Definitions
+
+/**
+ * @brief Report must fit in a single full-speed interrupt packet.
+ */
+#if (USB_HID_REPORT_SIZE > 64)
+#error "Report size must not exceed 64 bytes."
+#endif
+
+/**
+ * @brief The number of endpoints configured in MCC must include the HID
+ * endpoint.
+ */
+#if (DRV_USBHS_ENDPOINTS_NUMBER < (USB_HID_ENDPOINT_NUMBER + 1))
+#error "DRV_USBHS_ENDPOINTS_NUMBER must include the HID endpoint."
+#endif
+
+/**
+ * @brief Standard request GET_DESCRIPTOR.
+ */
+#define GET_DESCRIPTOR (0x06)
+
+/**
+ * @brief HID class requests.
+ */
+#define GET_REPORT (0x01)
+#define GET_IDLE (0x02)
+#define SET_IDLE (0x0A)
+
+//------------------------------------------------------------------------------
+// Function declarations
+
+static void InitializeByDescriptor(SYS_MODULE_INDEX index, USB_DEVICE_HANDLE usbDeviceHandle_, void* funcDriverInit, uint8_t interfaceNumber, uint8_t alternateSetting, uint8_t descriptorType, uint8_t * pDescriptor);
+static void Deinitialize(SYS_MODULE_INDEX index);
+static void ControlTransferNotification(SYS_MODULE_INDEX index, USB_DEVICE_EVENT controlEvent, USB_SETUP_PACKET * setupPacket);
+static void Tasks(SYS_MODULE_INDEX index);
+static void WriteTasks(void);
+static void WriteComplete(USB_DEVICE_IRP * irp);
+
+//------------------------------------------------------------------------------
+// Variables
+
+/**
+ * @brief Function driver. Implements the Harmony function driver interface
+ * directly. The device layer calls InitializeByDescriptor for each descriptor
+ * of the interface when the host sets the configuration, and Deinitialize when
+ * the device is detached, reset, or deconfigured.
+ */
+const USB_DEVICE_FUNCTION_DRIVER usbHidFunctionDriver = {
+    .initializeByDescriptor = InitializeByDescriptor,
+    .deInitialize = Deinitialize,
+    .controlTransferNotification = ControlTransferNotification,
+    .tasks = Tasks,
+    .globalInitialize = NULL,
+};
+static const uint8_t reportDescriptor[USB_HID_REPORT_DESCRIPTOR_SIZE] = {
+    0x06, 0x00, 0xFF, // usage page (vendor-defined)
+    0x09, 0x01, // usage (vendor-defined)
+    0xA1, 0x01, // collection (application)
+    0x09, 0x01, // usage (vendor-defined)
+    0x15, 0x00, // logical minimum (0)
+    0x26, 0xFF, 0x00, // logical maximum (255)
+    0x75, 0x08, // report size (8 bits)
+    0x95, USB_HID_REPORT_SIZE, // report count
+    0x81, 0x02, // input (data, variable, absolute)
+    0xC0, // end collection
+};
+static USB_DEVICE_HANDLE usbDeviceHandle = USB_DEVICE_HANDLE_INVALID;
+static USB_ENDPOINT_ADDRESS endpointAddress;
+static const uint8_t* hidDescriptor;
+static volatile bool configured;
+static uint8_t idleRate;
+static volatile uint32_t writesScheduled;
+static volatile uint32_t writesCompleted;
+static USB_DEVICE_IRP writeIrp;
+static uint8_t __attribute__((coherent, aligned(16))) writeRequestData[USB_HID_REPORT_SIZE]; // must be declared __attribute__((coherent)) for PIC32MZ devices
+static uint8_t writeData[USB_HID_WRITE_BUFFER_SIZE];
+static FifoMasked writeFifo = FIFO_MASKED(writeData, sizeof (writeData), 0);
+
+//------------------------------------------------------------------------------
+// Functions
+
+/**
+ * @brief Initialises the function for each descriptor of the interface. Called
+ * by the device layer when the host sets the configuration.
+ * @param index Function driver index.
+ * @param usbDeviceHandle_ Device layer handle.
+ * @param funcDriverInit Function driver initialisation data.
+ * @param interfaceNumber Interface number.
+ * @param alternateSetting Alternate setting.
+ * @param descriptorType Descriptor type.
+ * @param pDescriptor Descriptor.
+ */
+static void InitializeByDescriptor(SYS_MODULE_INDEX index, USB_DEVICE_HANDLE usbDeviceHandle_, void* funcDriverInit, uint8_t interfaceNumber, uint8_t alternateSetting, uint8_t descriptorType, uint8_t * pDescriptor) {
+    switch (descriptorType) {
+        case USB_HID_DESCRIPTOR_TYPE:
+            hidDescriptor = pDescriptor;
+            break;
+        case USB_DESCRIPTOR_ENDPOINT:
+        {
+            const USB_ENDPOINT_DESCRIPTOR * const endpointDescriptor = (USB_ENDPOINT_DESCRIPTOR *) pDescriptor;
+            usbDeviceHandle = usbDeviceHandle_;
+            endpointAddress = endpointDescriptor->bEndpointAddress;
+            USB_DEVICE_EndpointEnable(usbDeviceHandle, 0, endpointAddress, USB_TRANSFER_TYPE_INTERRUPT, endpointDescriptor->wMaxPacketSize);
+            idleRate = 0;
+            FifoMaskedClear(&writeFifo);
+            configured = true;
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+/**
+ * @brief Deinitialises the function. Called by the device layer when the
+ * device is detached, reset, or deconfigured. The write in progress is
+ * cancelled.
+ * @param index Function driver index.
+ */
+static void Deinitialize(SYS_MODULE_INDEX index) {
+    if (configured == false) {
+        return;
+    }
+    configured = false;
+    USB_DEVICE_IRPCancelAll(usbDeviceHandle, endpointAddress);
+    USB_DEVICE_EndpointDisable(usbDeviceHandle, endpointAddress);
+    writesCompleted = writesScheduled;
+}
+
+/**
+ * @brief Handles control transfers addressed to the interface. Only the
+ * requests required by a HID device without a boot interface are supported.
+ * @param index Function driver index.
+ * @param controlEvent Control transfer event.
+ * @param setupPacket Setup packet.
+ */
+static void ControlTransferNotification(SYS_MODULE_INDEX index, USB_DEVICE_EVENT controlEvent, USB_SETUP_PACKET * setupPacket) {
+    switch (controlEvent) {
+        case USB_DEVICE_EVENT_CONTROL_TRANSFER_SETUP_REQUEST:
+            break;
+        case USB_DEVICE_EVENT_CONTROL_TRANSFER_DATA_RECEIVED:
+            USB_DEVICE_ControlStatus(usbDeviceHandle, USB_DEVICE_CONTROL_STATUS_OK);
+            return;
+        default:
+            return;
+    }
+
+    // Standard requests
+    if (setupPacket->RequestType == USB_SETUP_REQUEST_TYPE_STANDARD) {
+        if (setupPacket->bRequest == GET_DESCRIPTOR) {
+            switch (setupPacket->W_Value.byte.HB) {
+                case USB_HID_DESCRIPTOR_TYPE:
+                    if (hidDescriptor == NULL) {
+                        break;
+                    }
+                    USB_DEVICE_ControlSend(usbDeviceHandle, (void*) hidDescriptor, setupPacket->wLength < hidDescriptor[0] ? setupPacket->wLength : hidDescriptor[0]);
+                    return;
+                case USB_HID_REPORT_DESCRIPTOR_TYPE:
+                    USB_DEVICE_ControlSend(usbDeviceHandle, (void*) reportDescriptor, setupPacket->wLength < sizeof (reportDescriptor) ? setupPacket->wLength : sizeof (reportDescriptor));
+                    return;
+                default:
+                    break;
+            }
+        }
+        USB_DEVICE_ControlStatus(usbDeviceHandle, USB_DEVICE_CONTROL_STATUS_ERROR);
+        return;
+    }
+
+    // Class requests
+    if (setupPacket->RequestType == USB_SETUP_REQUEST_TYPE_CLASS) {
+        switch (setupPacket->bRequest) {
+            case GET_REPORT:
+                USB_DEVICE_ControlSend(usbDeviceHandle, writeRequestData, setupPacket->wLength < sizeof (writeRequestData) ? setupPacket->wLength : sizeof (writeRequestData));
+                return;
+            case GET_IDLE:
+                USB_DEVICE_ControlSend(usbDeviceHandle, &idleRate, sizeof (idleRate));
+                return;
+            case SET_IDLE:
+                idleRate = setupPacket->W_Value.byte.HB; // reports are only sent on change so idle rate has no effect
+                USB_DEVICE_ControlStatus(usbDeviceHandle, USB_DEVICE_CONTROL_STATUS_OK);
+                return;
+            default:
+                break;
+        }
+    }
+    USB_DEVICE_ControlStatus(usbDeviceHandle, USB_DEVICE_CONTROL_STATUS_ERROR);
+}
+
+/**
+ * @brief Function tasks. Called by the device layer while the device is
+ * configured.
+ * @param index Function driver index.
+ */
+static void Tasks(SYS_MODULE_INDEX index) {
+    WriteTasks();
+}
+
+/**
+ * @brief Write tasks. A single report is written per transfer so that each
+ * report is sent in the next interrupt IN transaction.
+ */
+static void WriteTasks(void) {
+
+    // Do nothing if not configured or write in progress
+    if ((configured == false) || (writesScheduled != writesCompleted)) {
+        return;
+    }
+
+    // Do nothing if no report available
+    if (FifoMaskedRead(&writeFifo, writeRequestData, USB_HID_REPORT_SIZE) == 0) {
+        return;
+    }
+
+    // Schedule write
+    writeIrp.data = writeRequestData;
+    writeIrp.size = USB_HID_REPORT_SIZE;
+    writeIrp.flags = USB_DEVICE_IRP_FLAG_DATA_COMPLETE;
+    writeIrp.callback = WriteComplete;
+    writeIrp.userData = 0;
+    writesScheduled++; // increment before write because write may complete before function returns
+    if (USB_DEVICE_IRPSubmit(usbDeviceHandle, endpointAddress, &writeIrp) != USB_ERROR_NONE) {
+        writesScheduled--;
+    }
+}
+
+/**
+ * @brief Write complete callback. Called from the USB interrupt when the
+ * transfer is complete or cancelled.
+ * @param irp IRP.
+ */
+static void WriteComplete(USB_DEVICE_IRP * irp) {
+    if (writesCompleted != writesScheduled) {
+        writesCompleted++;
+    }
+    USB_HID_EVENT();
+}
+
+/**
+ * @brief Writes a report of USB_HID_REPORT_SIZE bytes. The report is discarded
+ * if the host has not configured the device.
+ * @param report Report.
+ * @return Result.
+ */
+FifoResult UsbHidWrite(const void* const report) {
+    if (configured == false) {
+        return FifoResultError;
+    }
+    const FifoResult result = FifoMaskedWrite(&writeFifo, report, USB_HID_REPORT_SIZE);
+    WriteTasks();
+    return result;
+}
+
+//------------------------------------------------------------------------------
+// End of file
@@ -0,0 +1,70 @@
+/**
+ * @file UsbHid.h
+ * @author Seb Madgwick
+ * @brief Vendor-defined USB HID function driver using MPLAB Harmony.
+ */
+
+#ifndef USB_HID_H
+#define USB_HID_H
+
+//------------------------------------------------------------------------------
+// Includes
+
+#include "Config.h"
+#include "Fifo.h"
+#include <stdint.h>
+#include "usb/src/usb_device_function_driver.h"
+
+//------------------------------------------------------------------------------
+// Definitions
+
+/**
+ * @brief Called when the main program loop should call SYS_Tasks, such as on
+ * the completion of a transfer. May be defined in Config.h to signal an event.
+ */
+#ifndef USB_HID_EVENT
+#define USB_HID_EVENT()
+#endif
+
+/**
+ * @brief HID descriptor type.
+ */
+#define USB_HID_DESCRIPTOR_TYPE (0x21)
+
+/**
+ * @brief Report descriptor type.
+ */
+#define USB_HID_REPORT_DESCRIPTOR_TYPE (0x22)
+
+/**
+ * @brief Report descriptor size. Required by the HID descriptor within the
+ * configuration descriptor.
+ */
+#define USB_HID_REPORT_DESCRIPTOR_SIZE (21)
+
+/**
+ * @brief Interrupt IN endpoint number. Required by the endpoint descriptor
+ * within the configuration descriptor. Must not be used by other functions.
+ */
+#define USB_HID_ENDPOINT_NUMBER (5)
+
+/**
+ * @brief Function driver to be registered in the USB device layer function
+ * driver registration table.
+ */
+#define USB_HID_FUNCTION_DRIVER (&usbHidFunctionDriver)
+
+//------------------------------------------------------------------------------
+// Variable declarations
+
+extern const USB_DEVICE_FUNCTION_DRIVER usbHidFunctionDriver;
+
+//------------------------------------------------------------------------------
+// Function declarations
+
+FifoResult UsbHidWrite(const void* const report);
+
+#endif
+
+//------------------------------------------------------------------------------
+// End of file
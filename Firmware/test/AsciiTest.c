@@ -0,0 +1,137 @@
+/**
+ * @file AsciiTest.c
+ * @author Seb Madgwick
+ * @brief Host test of the ASCII formatting in Ascii.h. AsciiFloatDecimals is
+ * compared with snprintf "%.*f" for a stride of all float bit patterns and for
+ * values close to rounding ties. AsciiDigits is compared with "%" PRIu64.
+ */
+
+//------------------------------------------------------------------------------
+// Includes
+
+#include "Ascii.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+//------------------------------------------------------------------------------
+// Definitions
+
+/**
+ * @brief Stride through float bit patterns.
+ */
+#define STRIDE (4099)
+
+//------------------------------------------------------------------------------
+// Function declarations
+
+static int CompareFloat(const float value, const int decimals);
+static int CompareDigits(const uint64_t value);
+
+//------------------------------------------------------------------------------
+// Functions
+
+/**
+ * @brief Compares AsciiFloatDecimals with snprintf.
+ * @return 1 if the strings differ.
+ */
+static int CompareFloat(const float value, const int decimals) {
+    char expected[64];
+    snprintf(expected, sizeof (expected), "%.*f", decimals, (double) value);
+    char actual[64];
+    size_t actualIndex = 0;
+    AsciiFloatDecimals(actual, sizeof (actual), &actualIndex, value, decimals);
+    if (actualIndex < sizeof (actual)) {
+        actual[actualIndex] = '\0';
+    }
+    if ((actualIndex >= sizeof (actual)) || (strcmp(expected, actual) != 0)) {
+        printf("Mismatch for %a at %d decimals: expected %s, actual %.*s\n", (double) value, decimals, expected, (int) actualIndex, actual);
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Compares AsciiDigits with snprintf.
+ * @return 1 if the strings differ.
+ */
+static int CompareDigits(const uint64_t value) {
+    char expected[32];
+    snprintf(expected, sizeof (expected), "%" PRIu64, value);
+    char actual[32];
+    size_t actualIndex = 0;
+    AsciiDigits(actual, sizeof (actual), &actualIndex, value, 1);
+    actual[actualIndex] = '\0';
+    if (strcmp(expected, actual) != 0) {
+        printf("Mismatch for %" PRIu64 ": actual %s\n", value, actual);
+        return 1;
+    }
+    return 0;
+}
+
+int main(void) {
+    int failures = 0;
+    uint64_t numberOfCases = 0;
+
+    // Stride through all float bit patterns
+    for (uint64_t bits = 0; bits <= UINT32_MAX; bits += STRIDE) {
+        const uint32_t bits32 = (uint32_t) bits;
+        float value;
+        memcpy(&value, &bits32, sizeof (value));
+        for (int decimals = 0; decimals <= ASCII_MAX_DECIMALS; decimals += 2) {
+            failures += CompareFloat(value, decimals);
+            numberOfCases++;
+        }
+    }
+
+    // Values close to rounding ties
+    for (int integer = -100000; integer <= 100000; integer++) {
+        for (int decimals = 0; decimals <= ASCII_MAX_DECIMALS; decimals++) {
+            const float tie = ((float) integer + 0.5f) / (float) (decimals == 0 ? 1 : 10);
+            failures += CompareFloat(tie, decimals);
+            failures += CompareFloat(nextafterf(tie, INFINITY), decimals);
+            failures += CompareFloat(nextafterf(tie, -INFINITY), decimals);
+            numberOfCases += 3;
+        }
+    }
+
+    // Special values
+    const float specials[] = {0.0f, -0.0f, INFINITY, -INFINITY, NAN, 9.0e12f, -9.0e12f, 8.99e12f, 3.4e38f, 1.0e-45f};
+    for (size_t index = 0; index < (sizeof (specials) / sizeof (float)); index++) {
+        for (int decimals = 0; decimals <= ASCII_MAX_DECIMALS; decimals++) {
+            failures += CompareFloat(specials[index], decimals);
+            numberOfCases++;
+        }
+    }
+
+    // Integers
+    uint64_t value = 0;
+    for (int index = 0; index < 1000000; index++) {
+        failures += CompareDigits(value);
+        failures += CompareDigits(UINT64_MAX - value);
+        value = (value * 6364136223846793005ULL) + 1442695040888963407ULL;
+        numberOfCases += 2;
+    }
+    failures += CompareDigits(UINT32_MAX);
+    failures += CompareDigits((uint64_t) UINT32_MAX + 1);
+
+    // Truncation
+    char destination[8];
+    size_t destinationIndex = 0;
+    const volatile float truncated = 12345.678f; // volatile avoids false positive -Warray-bounds from constant propagation
+    AsciiFloatDecimals(destination, sizeof (destination), &destinationIndex, truncated, 4);
+    if (destinationIndex <= sizeof (destination)) {
+        printf("Truncation not indicated\n");
+        failures++;
+    }
+
+    if (failures > 0) {
+        printf("ASCII formatting: %d of %" PRIu64 " cases failed\n", failures, numberOfCases);
+        return EXIT_FAILURE;
+    }
+    printf("ASCII formatting: %" PRIu64 " cases passed\n", numberOfCases);
+    return EXIT_SUCCESS;
+}
+
+//------------------------------------------------------------------------------
+// End of file
@@ -0,0 +1,167 @@
+/**
+ * @file BinaryTest.c
+ * @author Seb Madgwick
+ * @brief Host test and benchmark of the byte stuffing in Binary.h. The word at
+ * a time encoder, the in place encoder, and the decoder are checked against a
+ * byte at a time reference for random data and truncated destinations, then
+ * the word at a time and byte at a time encoders are timed.
+ */
+
+//------------------------------------------------------------------------------
+// Includes
+
+#include "Binary.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+//------------------------------------------------------------------------------
+// Definitions
+
+/**
+ * @brief Number of random correctness cases.
+ */
+#define NUMBER_OF_CASES (200000)
+
+/**
+ * @brief Benchmark payload size. Equal to a full serial accessory message.
+ */
+#define PAYLOAD_SIZE (1024)
+
+/**
+ * @brief Number of benchmark iterations.
+ */
+#define ITERATIONS (200000)
+
+//------------------------------------------------------------------------------
+// Function declarations
+
+static void Reference(void* const destination, const size_t destinationSize, size_t * const destinationIndex, const void* const data, const size_t numberOfBytes);
+static uint8_t RandomByte(const int escapeDensity);
+static double Seconds(void);
+static void Benchmark(const char* const name, const int escapeDensity);
+
+//------------------------------------------------------------------------------
+// Variables
+
+static volatile size_t sink;
+
+//------------------------------------------------------------------------------
+// Functions
+
+/**
+ * @brief Byte at a time reference encoder. Equivalent to BinaryBytes before
+ * the word at a time scan was added.
+ */
+static void Reference(void* const destination, const size_t destinationSize, size_t * const destinationIndex, const void* const data, const size_t numberOfBytes) {
+    for (size_t index = 0; index < numberOfBytes; index++) {
+        BinaryWrite(destination, destinationSize, destinationIndex, ((const uint8_t*) data)[index]);
+    }
+}
+
+/**
+ * @brief Returns a random byte. One in escapeDensity bytes is an end or escape
+ * byte. An escapeDensity of 0 never returns either.
+ */
+static uint8_t RandomByte(const int escapeDensity) {
+    if ((escapeDensity > 0) && ((rand() % escapeDensity) == 0)) {
+        return (rand() & 1) ? BYTE_STUFFING_END : BYTE_STUFFING_ESC;
+    }
+    uint8_t byte;
+    do {
+        byte = (uint8_t) rand();
+    } while ((byte == BYTE_STUFFING_END) || (byte == BYTE_STUFFING_ESC));
+    return byte;
+}
+
+/**
+ * @brief Returns monotonic time in seconds.
+ */
+static double Seconds(void) {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (double) time.tv_sec + ((double) time.tv_nsec * 1e-9);
+}
+
+/**
+ * @brief Prints the throughput of both encoders for a payload.
+ */
+static void Benchmark(const char* const name, const int escapeDensity) {
+    static uint8_t payload[PAYLOAD_SIZE];
+    static uint8_t destination[2 * PAYLOAD_SIZE];
+    for (size_t index = 0; index < sizeof (payload); index++) {
+        payload[index] = RandomByte(escapeDensity);
+    }
+    double start = Seconds();
+    for (int iteration = 0; iteration < ITERATIONS; iteration++) {
+        size_t destinationIndex = 0;
+        Reference(destination, sizeof (destination), &destinationIndex, payload, sizeof (payload));
+        sink = destinationIndex + destination[iteration % sizeof (destination)];
+    }
+    const double reference = Seconds() - start;
+    start = Seconds();
+    for (int iteration = 0; iteration < ITERATIONS; iteration++) {
+        size_t destinationIndex = 0;
+        BinaryBytes(destination, sizeof (destination), &destinationIndex, payload, sizeof (payload));
+        sink = destinationIndex + destination[iteration % sizeof (destination)];
+    }
+    const double word = Seconds() - start;
+    const double megabytes = ((double) ITERATIONS * PAYLOAD_SIZE) / 1e6;
+    printf("%-24s byte %8.1f MB/s, word %8.1f MB/s, %.2fx\n", name, megabytes / reference, megabytes / word, reference / word);
+}
+
+int main(void) {
+    srand(1);
+
+    // Compare encoder and decoder with reference
+    for (int testCase = 0; testCase < NUMBER_OF_CASES; testCase++) {
+        uint8_t data[64];
+        const size_t numberOfBytes = (size_t) (rand() % (sizeof (data) + 1));
+        const int escapeDensity = rand() % 8;
+        for (size_t index = 0; index < numberOfBytes; index++) {
+            data[index] = RandomByte(escapeDensity);
+        }
+        const size_t destinationSize = (size_t) (rand() % (2 * sizeof (data) + 1));
+        uint8_t expected[2 * sizeof (data)];
+        uint8_t actual[2 * sizeof (data)];
+        size_t expectedIndex = 0;
+        size_t actualIndex = 0;
+        Reference(expected, destinationSize, &expectedIndex, data, numberOfBytes);
+        BinaryBytes(actual, destinationSize, &actualIndex, data, numberOfBytes);
+        if ((expectedIndex != actualIndex) || ((expectedIndex <= destinationSize) && (memcmp(expected, actual, expectedIndex) != 0))) {
+            printf("Encode mismatch in case %d\n", testCase);
+            return EXIT_FAILURE;
+        }
+        uint8_t stuffed[2 * sizeof (data)];
+        size_t stuffedIndex = numberOfBytes < destinationSize ? numberOfBytes : destinationSize;
+        memcpy(stuffed, data, stuffedIndex);
+        if (numberOfBytes > destinationSize) {
+            stuffedIndex = destinationSize + 1; // truncated before stuffing
+        }
+        BinaryStuff(stuffed, destinationSize, &stuffedIndex, 0);
+        if (((stuffedIndex > destinationSize) != (expectedIndex > destinationSize)) || ((stuffedIndex <= destinationSize) && ((stuffedIndex != expectedIndex) || (memcmp(expected, stuffed, expectedIndex) != 0)))) {
+            printf("Stuff mismatch in case %d\n", testCase);
+            return EXIT_FAILURE;
+        }
+        if (expectedIndex > destinationSize) {
+            continue; // truncated
+        }
+        uint8_t decoded[sizeof (data)];
+        size_t decodedIndex = 0;
+        if ((BinaryDecode(decoded, sizeof (decoded), &decodedIndex, actual, actualIndex) != Ximu3ResultOk) || (decodedIndex != numberOfBytes) || (memcmp(decoded, data, numberOfBytes) != 0)) {
+            printf("Decode mismatch in case %d\n", testCase);
+            return EXIT_FAILURE;
+        }
+    }
+    printf("Binary encode/decode: %d cases passed\n", NUMBER_OF_CASES);
+
+    // Benchmark
+    Benchmark("No stuffing", 0);
+    Benchmark("1 in 128 bytes stuffed", 128); // equivalent to random data
+    Benchmark("1 in 4 bytes stuffed", 4);
+    Benchmark("Every byte stuffed", 1);
+    return EXIT_SUCCESS;
+}
+
+//------------------------------------------------------------------------------
+// End of file
@@ -0,0 +1,259 @@
+/**
+ * @file CompressionTest.c
+ * @author Seb Madgwick
+ * @brief Host test and benchmark of Compression.c. Random frames are encoded
+ * and decoded and each decoded value is compared with the quantised value.
+ * Values span the whole range written by the ASCII fast path. A lost message
+ * must be rejected until the next keyframe. The benchmark encodes correlated
+ * frames similar to the filtered ADC data and compares the size of each frame
+ * with the equivalent ASCII line, then times the ASCII, compression, and
+ * decompression of the frames.
+ */
+
+//------------------------------------------------------------------------------
+// Includes
+
+#include "Ascii.h"
+#include "Binary.h"
+#include "Stream/Compression.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+//------------------------------------------------------------------------------
+// Definitions
+
+/**
+ * @brief Number of messages.
+ */
+#define NUMBER_OF_MESSAGES (100000)
+
+/**
+ * @brief Maximum number of frames per message.
+ */
+#define MAX_FRAMES (8)
+
+/**
+ * @brief Number of benchmark frames. Equivalent to 10 minutes at the ADC
+ * sample rate of 375 Hz.
+ */
+#define BENCHMARK_FRAMES (225000)
+
+/**
+ * @brief Number of frames per benchmark message.
+ */
+#define BENCHMARK_BATCH_SIZE (8)
+
+/**
+ * @brief Benchmark frame period in microseconds.
+ */
+#define BENCHMARK_PERIOD (2667)
+
+/**
+ * @brief ADC full scale after oversampling. Equivalent to the scaling of
+ * Adc.c.
+ */
+#define ADC_FULL_SCALE (64.0f * 4095.0f)
+
+//------------------------------------------------------------------------------
+// Function declarations
+
+static float RandomValue(void);
+static double Seconds(void);
+static void Benchmark(void);
+
+//------------------------------------------------------------------------------
+// Variables
+
+static float benchmarkValues[BENCHMARK_FRAMES][COMPRESSION_NUMBER_OF_CHANNELS];
+static uint32_t benchmarkMicroseconds[BENCHMARK_FRAMES];
+static volatile size_t sink;
+
+//------------------------------------------------------------------------------
+// Functions
+
+/**
+ * @brief Returns a random value with a random magnitude up to 9e12.
+ */
+static float RandomValue(void) {
+    const float magnitude = powf(10.0f, ((float) rand() / (float) RAND_MAX) * 18.0f - 6.0f); // 1e-6 to 1e12
+    return ((rand() & 1) ? 1.0f : -1.0f) * magnitude * ((float) rand() / (float) RAND_MAX) * 9.0f;
+}
+
+/**
+ * @brief Returns monotonic time in seconds.
+ */
+static double Seconds(void) {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (double) time.tv_sec + ((double) time.tv_nsec * 1e-9);
+}
+
+/**
+ * @brief Prints the size of each frame compressed and as an ASCII line, with
+ * and without the byte stuffing of the serial accessory message, and the
+ * throughput of each encoder and the decoder. Each channel is a slow press
+ * and release with a different period and phase plus a few counts of noise,
+ * quantised to the ADC resolution. Throughput is of frame data, 4 bytes per
+ * channel.
+ */
+static void Benchmark(void) {
+
+    // Generate frames
+    for (int frame = 0; frame < BENCHMARK_FRAMES; frame++) {
+        const float seconds = (float) frame * (BENCHMARK_PERIOD * 1e-6f);
+        for (int channel = 0; channel < COMPRESSION_NUMBER_OF_CHANNELS; channel++) {
+            const float press = 0.5f + 0.45f * sinf((6.2831853f * seconds * (0.5f + (0.25f * (float) channel))) + (float) channel);
+            const float noise = (float) ((rand() % 9) - 4);
+            benchmarkValues[frame][channel] = roundf((press * ADC_FULL_SCALE) + noise) * (1.0f / ADC_FULL_SCALE);
+        }
+        benchmarkMicroseconds[frame] = BENCHMARK_PERIOD - 1 + (uint32_t) (rand() % 3); // jitter of timer capture
+    }
+
+    // ASCII lines
+    static uint8_t payload[COMPRESSION_HEADER_SIZE + (BENCHMARK_BATCH_SIZE * COMPRESSION_MAX_FRAME_SIZE)];
+    static uint8_t stuffed[2 * sizeof (payload)];
+    size_t asciiBytes = 0;
+    double start = Seconds();
+    for (int frame = 0; frame < BENCHMARK_FRAMES; frame += BENCHMARK_BATCH_SIZE) {
+        size_t payloadIndex = 0;
+        for (int index = frame; index < (frame + BENCHMARK_BATCH_SIZE); index++) {
+            AsciiDigits(payload, sizeof (payload), &payloadIndex, benchmarkMicroseconds[index], 1);
+            for (int channel = 0; channel < COMPRESSION_NUMBER_OF_CHANNELS; channel++) {
+                AsciiCharacter(payload, sizeof (payload), &payloadIndex, ',');
+                AsciiFloatDecimals(payload, sizeof (payload), &payloadIndex, benchmarkValues[index][channel], 6);
+            }
+            AsciiCharacter(payload, sizeof (payload), &payloadIndex, '\n');
+        }
+        asciiBytes += payloadIndex;
+        sink = payload[frame % payloadIndex];
+    }
+    const double asciiSeconds = Seconds() - start;
+
+    // Compressed
+    Compression encoder = {0};
+    static uint8_t messages[BENCHMARK_FRAMES / BENCHMARK_BATCH_SIZE][sizeof (payload)];
+    static size_t messageSizes[BENCHMARK_FRAMES / BENCHMARK_BATCH_SIZE];
+    size_t compressedBytes = 0;
+    start = Seconds();
+    for (int frame = 0; frame < BENCHMARK_FRAMES; frame += BENCHMARK_BATCH_SIZE) {
+        uint8_t * const message = messages[frame / BENCHMARK_BATCH_SIZE];
+        size_t messageIndex = 0;
+        CompressionEncodeHeader(&encoder, message, sizeof (payload), &messageIndex, frame == 0);
+        for (int index = frame; index < (frame + BENCHMARK_BATCH_SIZE); index++) {
+            CompressionEncodeFrame(&encoder, message, sizeof (payload), &messageIndex, benchmarkMicroseconds[index], benchmarkValues[index]);
+        }
+        messageSizes[frame / BENCHMARK_BATCH_SIZE] = messageIndex;
+        compressedBytes += messageIndex;
+    }
+    const double compressionSeconds = Seconds() - start;
+
+    // Decompressed
+    Compression decoder = {0};
+    CompressionFrame frames[BENCHMARK_BATCH_SIZE];
+    size_t numberOfFrames = 0;
+    start = Seconds();
+    for (int message = 0; message < (BENCHMARK_FRAMES / BENCHMARK_BATCH_SIZE); message++) {
+        if (CompressionDecode(&decoder, messages[message], messageSizes[message], frames, BENCHMARK_BATCH_SIZE, &numberOfFrames) != CompressionResultOk) {
+            printf("Benchmark message %d not decoded\n", message);
+            exit(EXIT_FAILURE);
+        }
+        sink = (size_t) frames[message % numberOfFrames].values[0];
+    }
+    const double decompressionSeconds = Seconds() - start;
+
+    // Byte stuffing
+    size_t compressedStuffedBytes = 0;
+    for (int message = 0; message < (BENCHMARK_FRAMES / BENCHMARK_BATCH_SIZE); message++) {
+        size_t stuffedIndex = 0;
+        BinaryBytes(stuffed, sizeof (stuffed), &stuffedIndex, messages[message], messageSizes[message]);
+        compressedStuffedBytes += stuffedIndex;
+    }
+    const size_t asciiStuffedBytes = asciiBytes + BENCHMARK_FRAMES; // each line termination is stuffed
+
+    // Print results
+    const double megabytes = ((double) BENCHMARK_FRAMES * COMPRESSION_NUMBER_OF_CHANNELS * sizeof (float)) / 1e6;
+    printf("%-24s %6.1f bytes/frame, %6.1f stuffed\n", "ASCII line", (double) asciiBytes / BENCHMARK_FRAMES, (double) asciiStuffedBytes / BENCHMARK_FRAMES);
+    printf("%-24s %6.1f bytes/frame, %6.1f stuffed, %.2fx smaller\n", "Compressed", (double) compressedBytes / BENCHMARK_FRAMES, (double) compressedStuffedBytes / BENCHMARK_FRAMES, (double) asciiStuffedBytes / (double) compressedStuffedBytes);
+    printf("%-24s %8.1f MB/s\n", "ASCII line encode", megabytes / asciiSeconds);
+    printf("%-24s %8.1f MB/s\n", "Compression encode", megabytes / compressionSeconds);
+    printf("%-24s %8.1f MB/s\n", "Compression decode", megabytes / decompressionSeconds);
+}
+
+int main(void) {
+    srand(1);
+    Compression encoder = {0};
+    Compression decoder = {0};
+
+    // Round trip
+    for (int message = 0; message < NUMBER_OF_MESSAGES; message++) {
+        uint8_t payload[COMPRESSION_HEADER_SIZE + (MAX_FRAMES * COMPRESSION_MAX_FRAME_SIZE)];
+        size_t payloadIndex = 0;
+        const size_t numberOfFrames = 1 + (size_t) (rand() % MAX_FRAMES);
+        float values[MAX_FRAMES][COMPRESSION_NUMBER_OF_CHANNELS];
+        CompressionEncodeHeader(&encoder, payload, sizeof (payload), &payloadIndex, (message % 100) == 0);
+        for (size_t frame = 0; frame < numberOfFrames; frame++) {
+            for (int channel = 0; channel < COMPRESSION_NUMBER_OF_CHANNELS; channel++) {
+                values[frame][channel] = RandomValue();
+            }
+            CompressionEncodeFrame(&encoder, payload, sizeof (payload), &payloadIndex, (uint32_t) rand(), values[frame]);
+        }
+        if (payloadIndex > sizeof (payload)) {
+            printf("Message %d truncated\n", message);
+            return EXIT_FAILURE;
+        }
+        CompressionFrame frames[MAX_FRAMES];
+        size_t numberOfDecodedFrames;
+        if ((CompressionDecode(&decoder, payload, payloadIndex, frames, MAX_FRAMES, &numberOfDecodedFrames) != CompressionResultOk) || (numberOfDecodedFrames != numberOfFrames)) {
+            printf("Message %d not decoded\n", message);
+            return EXIT_FAILURE;
+        }
+        for (size_t frame = 0; frame < numberOfFrames; frame++) {
+            for (int channel = 0; channel < COMPRESSION_NUMBER_OF_CHANNELS; channel++) {
+                if (frames[frame].values[channel] != CompressionQuantise(values[frame][channel])) {
+                    printf("Message %d frame %zu channel %d mismatch for %f\n", message, frame, channel, (double) values[frame][channel]);
+                    return EXIT_FAILURE;
+                }
+            }
+        }
+    }
+
+    // Values beyond the previous 32-bit range are not saturated
+    if ((CompressionQuantise(2147.5f) != 2147500000LL) || (CompressionQuantise(-1099511627776.0f) != -1099511627776000000LL)) {
+        printf("Quantisation saturated\n");
+        return EXIT_FAILURE;
+    }
+
+    // Lost message is rejected until next keyframe
+    const float values[COMPRESSION_NUMBER_OF_CHANNELS] = {0};
+    uint8_t payload[COMPRESSION_HEADER_SIZE + COMPRESSION_MAX_FRAME_SIZE];
+    CompressionFrame frames[1];
+    size_t numberOfFrames;
+    size_t payloadIndex = 0;
+    CompressionEncodeHeader(&encoder, payload, sizeof (payload), &payloadIndex, false); // lost
+    CompressionEncodeFrame(&encoder, payload, sizeof (payload), &payloadIndex, 0, values);
+    payloadIndex = 0;
+    CompressionEncodeHeader(&encoder, payload, sizeof (payload), &payloadIndex, false);
+    CompressionEncodeFrame(&encoder, payload, sizeof (payload), &payloadIndex, 0, values);
+    if (CompressionDecode(&decoder, payload, payloadIndex, frames, 1, &numberOfFrames) != CompressionResultError) {
+        printf("Message after lost message not rejected\n");
+        return EXIT_FAILURE;
+    }
+    payloadIndex = 0;
+    CompressionEncodeHeader(&encoder, payload, sizeof (payload), &payloadIndex, true);
+    CompressionEncodeFrame(&encoder, payload, sizeof (payload), &payloadIndex, 0, values);
+    if (CompressionDecode(&decoder, payload, payloadIndex, frames, 1, &numberOfFrames) != CompressionResultOk) {
+        printf("Keyframe after lost message not decoded\n");
+        return EXIT_FAILURE;
+    }
+
+    printf("Compression: %d messages passed\n", NUMBER_OF_MESSAGES);
+
+    // Benchmark
+    Benchmark();
+    return EXIT_SUCCESS;
+}
+
+//------------------------------------------------------------------------------
+// End of file
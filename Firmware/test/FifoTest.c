@@ -0,0 +1,433 @@
+/**
+ * @file FifoTest.c
+ * @author Seb Madgwick
+ * @brief Host stress test and benchmark of FifoMasked.h and FifoRecord.h. A
+ * producer thread and a consumer thread transfer a known sequence through each
+ * FIFO using a random mix of the write and read functions, and every byte and
+ * record is checked by the consumer. Each FIFO is then timed with fixed-size
+ * transfers.
+ */
+
+//------------------------------------------------------------------------------
+// Includes
+
+#include "FifoMasked.h"
+#include "FifoRecord.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+//------------------------------------------------------------------------------
+// Definitions
+
+/**
+ * @brief FIFO capacity in bytes. Equal to the UART FIFOs.
+ */
+#define CAPACITY (1024)
+
+/**
+ * @brief Reserve size in bytes.
+ */
+#define RESERVE_SIZE (256)
+
+/**
+ * @brief Number of records. Equal to the ADC FIFO.
+ */
+#define NUMBER_OF_RECORDS (64)
+
+/**
+ * @brief Number of bytes transferred by each stress test.
+ */
+#define STRESS_BYTES (64000000)
+
+/**
+ * @brief Number of records transferred by each stress test.
+ */
+#define STRESS_RECORDS (10000000)
+
+/**
+ * @brief Number of bytes transferred by each benchmark.
+ */
+#define BENCHMARK_BYTES (400000000)
+
+/**
+ * @brief Number of records transferred by each benchmark.
+ */
+#define BENCHMARK_RECORDS (40000000)
+
+/**
+ * @brief Record. Equal in size to an ADC sample.
+ */
+typedef struct {
+    uint32_t sequence;
+    uint32_t values[7];
+} Record;
+
+/**
+ * @brief Mode.
+ */
+typedef enum {
+    ModeStressCopy,
+    ModeStressInPlace,
+    ModeBenchmark,
+} Mode;
+
+//------------------------------------------------------------------------------
+// Function declarations
+
+static uint32_t Random(uint32_t * const state);
+static uint8_t Expected(const size_t position);
+static double Seconds(void);
+static void* MaskedProducer(void* const argument);
+static bool Check(const uint8_t * const data, const size_t numberOfBytes, const size_t position);
+static void* MaskedConsumer(void* const argument);
+static void* RecordProducer(void* const argument);
+static void* RecordConsumer(void* const argument);
+static bool Run(void* (*const producer)(void*), void* (*const consumer)(void*), const Mode mode_);
+static bool ClearTest(void);
+
+//------------------------------------------------------------------------------
+// Variables
+
+static uint8_t maskedData[CAPACITY + RESERVE_SIZE];
+static FifoStatistics maskedStatistics;
+static FifoMasked maskedFifo = FIFO_MASKED_WITH_STATISTICS(maskedData, CAPACITY, RESERVE_SIZE, &maskedStatistics);
+static Record records[NUMBER_OF_RECORDS];
+static FifoStatistics recordStatistics;
+static FifoRecord recordFifo = FIFO_RECORD_WITH_STATISTICS(records, &recordStatistics);
+static Mode mode;
+static size_t errorPosition;
+static bool error;
+
+//------------------------------------------------------------------------------
+// Functions
+
+/**
+ * @brief Returns a xorshift random number. rand is not thread safe.
+ */
+static uint32_t Random(uint32_t * const state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+/**
+ * @brief Returns the expected byte at a position in the stream. A lost,
+ * repeated, or reordered block of up to 64 KB changes the value.
+ */
+static uint8_t Expected(const size_t position) {
+    return (uint8_t) (position ^ (position >> 8) ^ (position >> 16));
+}
+
+/**
+ * @brief Returns monotonic time in seconds.
+ */
+static double Seconds(void) {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (double) time.tv_sec + ((double) time.tv_nsec * 1e-9);
+}
+
+/**
+ * @brief Writes the stream to the masked FIFO using a random mix of
+ * FifoMaskedWrite, FifoMaskedWriteByte, and FifoMaskedWriteReserve.
+ */
+static void* MaskedProducer(void* const argument) {
+    const size_t total = mode == ModeBenchmark ? BENCHMARK_BYTES : STRESS_BYTES;
+    uint32_t state = 1;
+    size_t position = 0;
+    uint8_t chunk[RESERVE_SIZE];
+    while ((position < total) && (__atomic_load_n(&error, __ATOMIC_RELAXED) == false)) {
+        if (mode == ModeBenchmark) {
+            for (size_t index = 0; index < 64; index++) {
+                chunk[index] = (uint8_t) (position + index);
+            }
+            if (FifoMaskedWrite(&maskedFifo, chunk, 64) == FifoResultOk) {
+                position += 64;
+            } else {
+                sched_yield();
+            }
+            continue;
+        }
+        const uint32_t random = Random(&state);
+        size_t numberOfBytes = 1 + ((random >> 8) % RESERVE_SIZE);
+        if (numberOfBytes > (total - position)) {
+            numberOfBytes = total - position;
+        }
+        bool written = false;
+        switch (random % 3) {
+            case 0:
+                for (size_t index = 0; index < numberOfBytes; index++) {
+                    chunk[index] = Expected(position + index);
+                }
+                written = FifoMaskedWrite(&maskedFifo, chunk, numberOfBytes) == FifoResultOk;
+                break;
+            case 1:
+                numberOfBytes = 1;
+                written = FifoMaskedWriteByte(&maskedFifo, Expected(position)) == FifoResultOk;
+                break;
+            default:
+            {
+                size_t available;
+                uint8_t * const space = FifoMaskedWriteReserve(&maskedFifo, &available);
+                if (numberOfBytes > available) {
+                    numberOfBytes = available;
+                }
+                for (size_t index = 0; index < numberOfBytes; index++) {
+                    space[index] = Expected(position + index);
+                }
+                FifoMaskedWriteCommit(&maskedFifo, numberOfBytes);
+                written = numberOfBytes > 0;
+                break;
+            }
+        }
+        if (written) {
+            position += numberOfBytes;
+        } else {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Checks bytes against the stream and sets the error flag if they do
+ * not match.
+ * @return True if the bytes match.
+ */
+static bool Check(const uint8_t * const data, const size_t numberOfBytes, const size_t position) {
+    for (size_t index = 0; index < numberOfBytes; index++) {
+        if (data[index] != Expected(position + index)) {
+            errorPosition = position + index;
+            __atomic_store_n(&error, true, __ATOMIC_RELAXED);
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Reads the stream from the masked FIFO and checks each byte. Copy mode
+ * uses a random mix of FifoMaskedRead and FifoMaskedReadByte. In place mode
+ * holds up to two acquired transfers, as UsbCdc does, and checks each in place
+ * when it is released so that an overwrite of acquired data is detected.
+ */
+static void* MaskedConsumer(void* const argument) {
+    const size_t total = mode == ModeBenchmark ? BENCHMARK_BYTES : STRESS_BYTES;
+    uint32_t state = 2;
+    size_t position = 0;
+    const uint8_t * acquiredData[2] = {NULL};
+    size_t acquiredSize[2] = {0};
+    uint8_t chunk[RESERVE_SIZE];
+    while (position < total) {
+        if (mode == ModeBenchmark) {
+            if (FifoMaskedRead(&maskedFifo, chunk, 64) == 0) {
+                sched_yield();
+                continue;
+            }
+            if (chunk[0] != (uint8_t) position) {
+                errorPosition = position;
+                __atomic_store_n(&error, true, __ATOMIC_RELAXED);
+                break;
+            }
+            position += 64;
+            continue;
+        }
+        const uint32_t random = Random(&state);
+        const size_t maxNumberOfBytes = 1 + ((random >> 8) % RESERVE_SIZE);
+        if (mode == ModeStressCopy) {
+            size_t numberOfBytes = 0;
+            if ((random & 1) != 0) {
+                numberOfBytes = FifoMaskedRead(&maskedFifo, chunk, maxNumberOfBytes);
+            } else if (FifoMaskedAvailableRead(&maskedFifo) > 0) {
+                chunk[0] = FifoMaskedReadByte(&maskedFifo);
+                numberOfBytes = 1;
+            }
+            if (numberOfBytes == 0) {
+                sched_yield();
+                continue;
+            }
+            if (Check(chunk, numberOfBytes, position) == false) {
+                break;
+            }
+            position += numberOfBytes;
+            continue;
+        }
+
+        // Release oldest transfer
+        if ((acquiredSize[1] > 0) || (((random & 1) != 0) && (acquiredSize[0] > 0))) {
+            if (Check(acquiredData[0], acquiredSize[0], position) == false) {
+                break;
+            }
+            position += acquiredSize[0];
+            FifoMaskedReadRelease(&maskedFifo, acquiredSize[0]);
+            acquiredData[0] = acquiredData[1];
+            acquiredSize[0] = acquiredSize[1];
+            acquiredSize[1] = 0;
+            continue;
+        }
+
+        // Acquire transfer
+        size_t numberOfBytes;
+        const uint8_t * const data = FifoMaskedReadPeek(&maskedFifo, &numberOfBytes);
+        if (numberOfBytes > maxNumberOfBytes) {
+            numberOfBytes = maxNumberOfBytes;
+        }
+        if (numberOfBytes == 0) {
+            if (acquiredSize[0] == 0) {
+                sched_yield();
+            }
+            continue;
+        }
+        FifoMaskedReadAcquire(&maskedFifo, numberOfBytes);
+        const int slot = acquiredSize[0] == 0 ? 0 : 1;
+        acquiredData[slot] = data;
+        acquiredSize[slot] = numberOfBytes;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Writes numbered records to the record FIFO.
+ */
+static void* RecordProducer(void* const argument) {
+    const uint32_t total = mode == ModeBenchmark ? BENCHMARK_RECORDS : STRESS_RECORDS;
+    uint32_t sequence = 0;
+    while ((sequence < total) && (__atomic_load_n(&error, __ATOMIC_RELAXED) == false)) {
+        Record * const record = FifoRecordWriteReserve(&recordFifo);
+        if (record == NULL) {
+            sched_yield();
+            continue;
+        }
+        record->sequence = sequence;
+        for (int index = 0; index < 7; index++) {
+            record->values[index] = sequence * (uint32_t) (index + 1);
+        }
+        FifoRecordWriteCommit(&recordFifo);
+        sequence++;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Reads records from the record FIFO and checks each record in place.
+ */
+static void* RecordConsumer(void* const argument) {
+    const uint32_t total = mode == ModeBenchmark ? BENCHMARK_RECORDS : STRESS_RECORDS;
+    uint32_t sequence = 0;
+    while (sequence < total) {
+        const Record * const record = FifoRecordReadPeek(&recordFifo);
+        if (record == NULL) {
+            sched_yield();
+            continue;
+        }
+        bool valid = record->sequence == sequence;
+        for (int index = 0; index < 7; index++) {
+            valid = valid && (record->values[index] == (sequence * (uint32_t) (index + 1)));
+        }
+        if (valid == false) {
+            errorPosition = sequence;
+            __atomic_store_n(&error, true, __ATOMIC_RELAXED);
+            break;
+        }
+        FifoRecordReadRelease(&recordFifo);
+        sequence++;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Runs a producer and consumer in separate threads.
+ * @return True if the consumer found no errors.
+ */
+static bool Run(void* (*const producer)(void*), void* (*const consumer)(void*), const Mode mode_) {
+    mode = mode_;
+    error = false;
+    pthread_t producerThread;
+    pthread_t consumerThread;
+    pthread_create(&producerThread, NULL, producer, NULL);
+    pthread_create(&consumerThread, NULL, consumer, NULL);
+    pthread_join(consumerThread, NULL);
+    pthread_join(producerThread, NULL); // producer stops on error
+    return error == false;
+}
+
+/**
+ * @brief Checks that FifoMaskedClear discards acquired data.
+ * @return True if passed.
+ */
+static bool ClearTest(void) {
+    static uint8_t data[16];
+    FifoMasked fifo = FIFO_MASKED(data, sizeof (data), 0);
+    FifoMaskedWrite(&fifo, "0123456789", 10);
+    size_t available;
+    FifoMaskedReadPeek(&fifo, &available);
+    FifoMaskedReadAcquire(&fifo, 5);
+    FifoMaskedClear(&fifo);
+    FifoMaskedReadPeek(&fifo, &available);
+    if ((available != 0) || (FifoMaskedAvailableWrite(&fifo) != sizeof (data))) {
+        return false;
+    }
+    FifoMaskedWrite(&fifo, "ab", 2);
+    const char* const peek = FifoMaskedReadPeek(&fifo, &available);
+    return (available == 2) && (memcmp(peek, "ab", 2) == 0);
+}
+
+int main(void) {
+
+    // Clear
+    if (ClearTest() == false) {
+        printf("FifoMaskedClear did not discard acquired data\n");
+        return EXIT_FAILURE;
+    }
+
+    // Stress
+    if (Run(MaskedProducer, MaskedConsumer, ModeStressCopy) == false) {
+        printf("FifoMasked copy mismatch at byte %zu\n", errorPosition);
+        return EXIT_FAILURE;
+    }
+    FifoMaskedClear(&maskedFifo); // copy reads do not advance the acquire index
+    if (Run(MaskedProducer, MaskedConsumer, ModeStressInPlace) == false) {
+        printf("FifoMasked in place mismatch at byte %zu\n", errorPosition);
+        return EXIT_FAILURE;
+    }
+    if (maskedStatistics.maxOccupancy > CAPACITY) {
+        printf("FifoMasked statistics invalid\n");
+        return EXIT_FAILURE;
+    }
+    printf("FifoMasked: %d bytes passed in each mode, %u overflows\n", STRESS_BYTES, maskedStatistics.numberOfOverflows);
+    if (Run(RecordProducer, RecordConsumer, ModeStressCopy) == false) {
+        printf("FifoRecord mismatch at record %zu\n", errorPosition);
+        return EXIT_FAILURE;
+    }
+    if (recordStatistics.maxOccupancy > NUMBER_OF_RECORDS) {
+        printf("FifoRecord statistics invalid\n");
+        return EXIT_FAILURE;
+    }
+    printf("FifoRecord: %d records passed, %u overflows\n", STRESS_RECORDS, recordStatistics.numberOfOverflows);
+
+    // Benchmark
+    FifoMaskedClear(&maskedFifo);
+    double start = Seconds();
+    if (Run(MaskedProducer, MaskedConsumer, ModeBenchmark) == false) {
+        printf("FifoMasked benchmark mismatch at byte %zu\n", errorPosition);
+        return EXIT_FAILURE;
+    }
+    const double masked = Seconds() - start;
+    start = Seconds();
+    if (Run(RecordProducer, RecordConsumer, ModeBenchmark) == false) {
+        printf("FifoRecord benchmark mismatch at record %zu\n", errorPosition);
+        return EXIT_FAILURE;
+    }
+    const double record = Seconds() - start;
+    printf("FifoMasked 64-byte transfers %8.1f MB/s\n", ((double) BENCHMARK_BYTES / 1e6) / masked);
+    printf("FifoRecord %zu-byte records  %8.1f M records/s\n", sizeof (Record), ((double) BENCHMARK_RECORDS / 1e6) / record);
+    return EXIT_SUCCESS;
+}
+
+//------------------------------------------------------------------------------
+// End of file